@@ -0,0 +1,23 @@
+# Times a full rebuild of the build-time benchmark targets of a configured build tree.
+#
+# cmake -S . -B build -G Ninja -DINJECTTOR_BENCHMARKS=ON -DINJECTTOR_MODULE=ON
+# cmake -DBUILD_DIR=build -P Benchmarks/BuildTime/CompareBuildTimes.cmake
+
+if (NOT BUILD_DIR)
+    message(FATAL_ERROR "Pass the configured build tree with -DBUILD_DIR=<path>")
+endif ()
+
+foreach (target BuildTimeHeader BuildTimeModule)
+    string(TIMESTAMP start "%s%f")
+    execute_process(COMMAND ${CMAKE_COMMAND} --build ${BUILD_DIR} --target ${target} --clean-first
+                    RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+    string(TIMESTAMP end "%s%f")
+
+    if (NOT result EQUAL 0)
+        message(STATUS "${target}: not built, configure with -DINJECTTOR_MODULE=ON for the module variant")
+        continue()
+    endif ()
+
+    math(EXPR milliseconds "(${end} - ${start}) / 1000")
+    message(STATUS "${target}: full rebuild in ${milliseconds} ms")
+endforeach ()
@@ -0,0 +1,115 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers a few hundred services from several threads at once, each thread resolving what it registered so far
+// between two registrations, and reports the throughput for every thread count.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Container.hpp"
+
+namespace {
+
+    constexpr int Types = 512;
+    constexpr int ResolvesPerRegistration = 16;
+
+    template<int N>
+    struct IService {
+        virtual ~IService() = default;
+
+        virtual int Id() const = 0;
+    };
+
+    template<int N>
+    struct Service : IService<N> {
+        int Id() const override {
+            return N;
+        }
+    };
+
+    using Operation = void (*)(DI::Container &);
+
+    template<int N>
+    void Register(DI::Container &container) {
+        if constexpr (N % 2 == 0) {
+            container.RegisterSingleton<IService<N>, Service<N>>();
+        } else {
+            container.RegisterTransient<IService<N>, Service<N>>();
+        }
+    }
+
+    template<int N>
+    void Resolve(DI::Container &container) {
+        if constexpr (N % 2 == 0) {
+            container.ResolveSingleton<IService<N>>();
+        } else {
+            container.ResolveTransient<IService<N>>();
+        }
+    }
+
+    template<int... N>
+    constexpr std::array<Operation, Types> Registrations(std::integer_sequence<int, N...>) {
+        return {&Register<N>...};
+    }
+
+    template<int... N>
+    constexpr std::array<Operation, Types> Resolves(std::integer_sequence<int, N...>) {
+        return {&Resolve<N>...};
+    }
+
+    constexpr auto registrations = Registrations(std::make_integer_sequence<int, Types>{});
+    constexpr auto resolves = Resolves(std::make_integer_sequence<int, Types>{});
+
+    /**
+    * @return double The seconds it took for the threads to register every type.
+    */
+    double Run(unsigned threads) {
+        DI::Container container;
+
+        auto work = [&container, threads](unsigned thread) {
+            std::vector<int> registered;
+            for (int type = static_cast<int>(thread); type < Types; type += static_cast<int>(threads)) {
+                registrations[type](container);
+                registered.push_back(type);
+
+                for (int i = 0; i < ResolvesPerRegistration; i++) {
+                    resolves[registered[(type * 31 + i) % registered.size()]](container);
+                }
+            }
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned thread = 1; thread < threads; thread++) {
+            workers.emplace_back(work, thread);
+        }
+
+        work(0);
+        for (auto &worker: workers) {
+            worker.join();
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+int main() {
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%8s %16s %16s\n", "threads", "registrations/s", "resolves/s");
+    for (unsigned threads = 1; threads <= cores * 2; threads *= 2) {
+        double best = Run(threads);
+        for (int round = 0; round < 4; round++) {
+            best = std::min(best, Run(threads));
+        }
+
+        std::printf("%8u %16.0f %16.0f\n", threads, Types / best, Types * ResolvesPerRegistration / best);
+    }
+
+    return 0;
+}
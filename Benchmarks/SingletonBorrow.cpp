@@ -0,0 +1,80 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves the same singleton from a growing number of threads, once through ResolveSingleton, which copies a
+// shared_ptr and bounces its reference count between the cores, then through ResolveSingletonRef, which borrows it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "Container.hpp"
+
+namespace {
+
+    constexpr int ResolvesPerThread = 1 << 20;
+
+    struct IConfig {
+        virtual ~IConfig() = default;
+
+        virtual int Value() const = 0;
+    };
+
+    struct Config : IConfig {
+        int Value() const override {
+            return 1;
+        }
+    };
+
+    /**
+    * @return double The nanoseconds per resolve, all threads resolving at once.
+    */
+    template<typename TResolve>
+    double Run(unsigned threads, TResolve resolve) {
+        std::atomic<unsigned> ready{0};
+        std::atomic<long> total{0};
+        auto work = [&]() {
+            ready.fetch_add(1);
+            while (ready.load() < threads) {
+            }
+
+            long sum = 0;
+            for (int i = 0; i < ResolvesPerThread; i++) {
+                sum += resolve();
+            }
+
+            total.fetch_add(sum);
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned thread = 1; thread < threads; thread++) {
+            workers.emplace_back(work);
+        }
+
+        work();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return total.load() == static_cast<long>(threads) * ResolvesPerThread ? seconds * 1e9 / ResolvesPerThread : 0;
+    }
+
+}
+
+int main() {
+    DI::Container container;
+    container.RegisterSingleton<IConfig, Config>();
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%8s %18s %18s   ns per resolve and thread\n", "threads", "ResolveSingleton", "ResolveSingletonRef");
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+        auto shared = Run(threads, [&container]() { return container.ResolveSingleton<IConfig>()->Value(); });
+        auto borrowed = Run(threads, [&container]() { return container.ResolveSingletonRef<IConfig>().Value(); });
+        std::printf("%8u %18.1f %18.1f\n", threads, shared, borrowed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+# Times a full rebuild of every stress benchmark of a configured build tree, then runs it. Runs StressTags last.
+#
+# cmake -S . -B build -DCMAKE_BUILD_TYPE=Release -DINJECTTOR_BENCHMARKS=ON -DINJECTTOR_STRESS_SIZES="1000;10000"
+# cmake -DBUILD_DIR=build -P Benchmarks/Stress/RunStress.cmake
+
+if (NOT BUILD_DIR)
+    message(FATAL_ERROR "Pass the configured build tree with -DBUILD_DIR=<path>")
+endif ()
+
+load_cache(${BUILD_DIR} READ_WITH_PREFIX "" INJECTTOR_STRESS_SIZES)
+
+foreach (size ${INJECTTOR_STRESS_SIZES})
+    string(TIMESTAMP start "%s%f")
+    execute_process(COMMAND ${CMAKE_COMMAND} --build ${BUILD_DIR} --target Stress${size} --clean-first
+                    RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+    string(TIMESTAMP end "%s%f")
+
+    if (NOT result EQUAL 0)
+        message(STATUS "Stress${size}: build failed")
+        continue()
+    endif ()
+
+    math(EXPR milliseconds "(${end} - ${start}) / 1000")
+    message(STATUS "Stress${size}: full rebuild in ${milliseconds} ms")
+
+    execute_process(COMMAND ${BUILD_DIR}/Benchmarks/Stress/Stress${size} OUTPUT_VARIABLE report)
+    message("${report}")
+endforeach ()
+
+execute_process(COMMAND ${CMAKE_COMMAND} --build ${BUILD_DIR} --target StressTags RESULT_VARIABLE result
+                OUTPUT_QUIET ERROR_QUIET)
+if (result EQUAL 0)
+    execute_process(COMMAND ${BUILD_DIR}/Benchmarks/Stress/StressTags OUTPUT_VARIABLE report)
+    message("${report}")
+else ()
+    message(STATUS "StressTags: build failed")
+endif ()
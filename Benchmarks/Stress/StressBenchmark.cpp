@@ -0,0 +1,124 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers a generated fixture in a new container, then reports how long that took, how much memory the container
+// holds afterwards, and the latency percentiles of resolves at every level of the dependency graph.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "StressFixture.hpp"
+
+namespace {
+
+    constexpr int SamplesPerLevel = 20000;
+
+    // Bytes currently allocated through operator new, whoever allocated them
+    std::atomic<std::size_t> liveBytes{0};
+
+    // Keeps the resolved services in use, so that nothing is optimized away
+    volatile int sink;
+
+    double Percentile(const std::vector<double> &sorted, double percentile) {
+        return sorted[static_cast<std::size_t>(percentile * static_cast<double>(sorted.size() - 1))];
+    }
+
+}
+
+void *operator new(std::size_t size) {
+    // The size is kept in front of the block, which stays aligned for any type
+    auto block = static_cast<std::max_align_t *>(std::malloc(size + sizeof(std::max_align_t)));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t *>(block) = size;
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return block + 1;
+}
+
+void operator delete(void *pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+
+    auto block = static_cast<std::max_align_t *>(pointer) - 1;
+    liveBytes.fetch_sub(*reinterpret_cast<std::size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+int main() {
+    auto &fixture = Stress::Generated;
+    int registrations = fixture.types * fixture.tags;
+    std::printf("%d interfaces, %d registrations, dependency depth %d, width %d\n", fixture.types, registrations,
+                fixture.depth, fixture.width);
+
+    auto before = liveBytes.load();
+    auto container = std::make_unique<DI::Container>();
+    Stress::Active = container.get();
+
+    auto start = std::chrono::steady_clock::now();
+    fixture.registerAll(*container);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto footprint = liveBytes.load() - before;
+    std::printf("registration: %.1f ms, %.0f ns per registration\n", seconds * 1e3, seconds * 1e9 / registrations);
+    std::printf("memory: %zu bytes, %zu bytes per registration, singleton instances included\n", footprint,
+                footprint / static_cast<std::size_t>(registrations));
+
+    auto usage = container->MemoryStats();
+    std::printf("  registry %zu, singleton tables %zu, descriptors %zu, bookkeeping %zu, instances %zu\n",
+                usage.registry, usage.singletonTable, usage.descriptors, usage.bookkeeping, usage.instances);
+
+    start = std::chrono::steady_clock::now();
+    container->Validate();
+    std::printf("validation: %.1f ms\n",
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    std::vector<std::string> tags;
+    for (int tag = 0; tag < fixture.tags; tag++) {
+        tags.push_back(Stress::TagOf(tag));
+    }
+
+    // Level 0 resolves the deepest graphs, the last level holds the singletons
+    std::printf("\n%6s %10s %10s %10s %10s %10s   resolve latency in ns\n", "level", "p50", "p90", "p99", "p99.9",
+                "max");
+    std::mt19937 random(42);
+    int levels = fixture.depth + 1;
+    for (int level = 0; level < levels && level < fixture.types; level++) {
+        // Picked up front, so that only the resolves are timed
+        std::uniform_int_distribution<int> types(0, (fixture.types - 1 - level) / levels);
+        std::uniform_int_distribution<int> tagOf(0, fixture.tags - 1);
+        std::vector<std::pair<int, int>> picks(SamplesPerLevel);
+        for (auto &pick: picks) {
+            pick = {types(random) * levels + level, tagOf(random)};
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(picks.size());
+        for (auto [type, tag]: picks) {
+            auto resolveStart = std::chrono::steady_clock::now();
+            sink = fixture.resolvers[type](*container, tags[tag]);
+            latencies.push_back(std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - resolveStart).count());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%6d %10.0f %10.0f %10.0f %10.0f %10.0f\n", level, Percentile(latencies, 0.5),
+                    Percentile(latencies, 0.9), Percentile(latencies, 0.99), Percentile(latencies, 0.999),
+                    latencies.back());
+    }
+
+    return 0;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_STRESSFIXTURE_HPP
+#define INJECTTORTEST_STRESSFIXTURE_HPP
+
+#include <string>
+#include "Container.hpp"
+
+/*
+* What the stress benchmark knows about a generated fixture, see CMakeLists.txt for how it is generated.
+*
+* Service i of the fixture sits on level i % (depth + 1) of the dependency graph. Services on the last level are
+* singletons without dependencies; every other service is transient and resolves, in its constructor, width services
+* of the next level. Each interface is registered once per tag.
+*/
+namespace Stress {
+
+    // The container the generated implementations resolve their dependencies from
+    inline DI::Container *Active = nullptr;
+
+    // Resolves the service of one interface under a tag, and calls it
+    using Resolver = int (*)(DI::Container &, const std::string &);
+
+    struct Fixture {
+        int types;
+        int depth;
+        int width;
+        int tags;
+        void (*registerAll)(DI::Container &);
+        const Resolver *resolvers;  // one per interface, by index
+    };
+
+    // Defined by the generated Fixture.cpp
+    extern const Fixture Generated;
+
+    inline std::string TagOf(int index) {
+        return index ? "Tag" + std::to_string(index) : std::string();
+    }
+
+}
+
+#endif //INJECTTORTEST_STRESSFIXTURE_HPP
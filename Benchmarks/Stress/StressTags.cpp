@@ -0,0 +1,102 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers one interface under many tags, for each count in INJECTTOR_STRESS_TAG_COUNTS and each lifetime, then
+// reports how long the registrations took, how long resolving the last tag and resolving them all take afterwards.
+// Registering a tag must cost the same whatever the number of tags already registered.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Container.hpp"
+
+namespace {
+
+    constexpr int Resolves = 10000;
+
+    struct IPlugin {
+        virtual ~IPlugin() = default;
+
+        virtual int Value() = 0;
+    };
+
+    struct Plugin : IPlugin {
+        int Value() override {
+            return 1;
+        }
+    };
+
+    // Keeps the resolved services in use, so that nothing is optimized away
+    volatile int sink;
+
+    double Elapsed(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template<DI::Lifetime lifetime>
+    void Run(int count) {
+        std::vector<std::string> tags;
+        for (int tag = 0; tag < count; tag++) {
+            tags.push_back("Tag" + std::to_string(tag));
+        }
+
+        DI::Container container;
+        auto start = std::chrono::steady_clock::now();
+        for (auto &tag: tags) {
+            if constexpr (lifetime == DI::Lifetime::Singleton) {
+                container.RegisterSingleton<IPlugin, Plugin>(tag);
+            } else {
+                container.RegisterTransient<IPlugin, Plugin>(tag);
+            }
+        }
+
+        auto registration = Elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Resolves; i++) {
+            if constexpr (lifetime == DI::Lifetime::Singleton) {
+                sink = container.ResolveSingleton<IPlugin>(tags.back())->Value();
+            } else {
+                sink = container.ResolveTransient<IPlugin>(tags.back())->Value();
+            }
+        }
+
+        auto resolve = Elapsed(start) / Resolves;
+
+        start = std::chrono::steady_clock::now();
+        if constexpr (lifetime == DI::Lifetime::Singleton) {
+            sink = static_cast<int>(container.ResolveAllSingletons<IPlugin>()->size());
+        } else {
+            sink = static_cast<int>(container.ResolveAllTransients<IPlugin>().size());
+        }
+
+        auto all = Elapsed(start);
+
+        std::printf("%10s %8d %12.1f %12.0f %12.0f %14.1f\n",
+                    lifetime == DI::Lifetime::Singleton ? "singleton" : "transient", count, registration / 1e6,
+                    registration / count, resolve, all / 1e3);
+    }
+
+}
+
+int main(int argc, char **argv) {
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back(std::atoi(argv[i]));
+    }
+
+    if (counts.empty()) {
+        counts = {INJECTTOR_STRESS_TAG_COUNTS};
+    }
+
+    std::printf("%10s %8s %12s %12s %12s %14s\n", "lifetime", "tags", "register ms", "ns per tag", "resolve ns",
+                "resolve all us");
+    for (auto count: counts) {
+        Run<DI::Lifetime::Transient>(count);
+        Run<DI::Lifetime::Singleton>(count);
+    }
+
+    return 0;
+}
@@ -4,85 +4,206 @@
 #ifndef INJECTTORTEST_CONTAINER_HPP
 #define INJECTTORTEST_CONTAINER_HPP
 
-#include <typeinfo>
 #include <unordered_map>
 #include <memory>
-#include <stdexcept>
+#include <memory_resource>
+#include <vector>
+#include <unordered_set>
+#include <set>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include "DisposalQueue.hpp"
+#include "ServiceDescriptor.hpp"
+#include "EpochReclaimer.hpp"
+#include "MemoryAccount.hpp"
+#include "ServiceRegistry.hpp"
+#include "ThreadLocalStore.hpp"
+
+// Defined to 1 by the InjecttorCore target, whose ContainerCore.cpp holds the only copy of the non-template core
+#ifndef INJECTTOR_STATIC_CORE
+#define INJECTTOR_STATIC_CORE 0
+#endif
 
 namespace DI {
 
     /**
-    * @class BaseService
+    * @class ThreadResolveCache
     *
-    * @brief The BaseService class provides an interface for erased services.
+    * @brief The ThreadResolveCache class is a small, direct-mapped, per-thread cache of resolved registrations.
     *
-    * This class serves as a base class for erased services. Erased services are services
-    * that can be utilized without knowing the exact type. This class provides a virtual
-    * destructor to allow proper destruction of derived classes.
+    * Every thread owns a fixed table mapping (container, lifetime, type, tag) to the service entry found in the
+    * container maps. Entries are validated against a process-wide registry epoch, bumped by every registration, so
+    * a hit reads thread-local memory and a single read-mostly counter, and never touches the shared maps.
     */
-    class BaseService {
+    class ThreadResolveCache {
     public:
-        virtual ~BaseService() = default;
-    };
+        static constexpr std::size_t Slots = 64;
+
+        static std::atomic<std::uint64_t> &Epoch() {
+            static std::atomic<std::uint64_t> epoch{1};
+            return epoch;
+        }
+
+        static ServiceDescriptor *Find(std::uint64_t owner, Lifetime lifetime, TypeId type, const std::string &tag) {
+            auto &slot = Table()[Index(owner, lifetime, type, tag)];
+            if (slot.epoch != Epoch().load(std::memory_order_acquire) || slot.owner != owner ||
+                slot.type != type || slot.lifetime != lifetime || slot.tag != tag) {
+                return nullptr;
+            }
+
+            return slot.service;
+        }
 
-    template<class T>
-    using CreatorSharedFnc = std::function<std::shared_ptr<T>()>;
+        static void Store(std::uint64_t epoch, std::uint64_t owner, Lifetime lifetime, TypeId type,
+                          const std::string &tag, ServiceDescriptor *service) {
+            auto &slot = Table()[Index(owner, lifetime, type, tag)];
+            slot.epoch = epoch;
+            slot.owner = owner;
+            slot.type = type;
+            slot.lifetime = lifetime;
+            slot.tag = tag;
+            slot.service = service;
+        }
+
+    private:
+        struct Slot {
+            std::uint64_t epoch = 0;
+            std::uint64_t owner = 0;
+            TypeId type = nullptr;
+            Lifetime lifetime = Lifetime::Singleton;
+            std::string tag;
+            ServiceDescriptor *service = nullptr;
+        };
 
-    using MapType = std::unordered_map<std::string, std::shared_ptr<BaseService>>;
+        static std::array<Slot, Slots> &Table() {
+            thread_local std::array<Slot, Slots> table;
+            return table;
+        }
+
+        static std::size_t Index(std::uint64_t owner, Lifetime lifetime, TypeId type, const std::string &tag) {
+            std::size_t hash = std::hash<TypeId>()(type) ^ std::hash<std::string>()(tag);
+            hash ^= (owner * 0x9E3779B97F4A7C15ull) + static_cast<std::size_t>(lifetime);
+            return (hash ^ (hash >> 17)) & (Slots - 1);
+        }
+    };
 
     /**
-    * @class TypedService
+    * @class BorrowCache
     *
-    * @brief The TypedService class provides a typed service implementation.
+    * @brief The BorrowCache class is a small, direct-mapped, per-thread cache of the singletons lent by
+    * Container::ResolveSingletonRef.
     *
-    * This class is a sub-class of BaseService and provides a way to create and access
-    * a typed service. It stores a creator function that can be used to create instances
-    * of the service type T. The creator function is a std::function that returns a
-    * std::shared_ptr<T>.
+    * Entries hold the instance pointer itself and are validated against the registry epoch of ThreadResolveCache,
+    * which Replace and Shutdown bump before releasing anything. A hit reads thread-local memory and that counter
+    * only, it never reads the shared tables and needs no EpochReclaimer::ReadGuard. Per-node singletons are cached
+    * along with the node they were lent on.
     */
-    template<class T>
-    class TypedService : public BaseService {
+    class BorrowCache {
     public:
+        static constexpr std::size_t Slots = 32;
 
-        void SetCreator(CreatorSharedFnc<T> crt) {
-            this->creator = crt;
+        struct Slot {
+            std::uint64_t epoch = 0;
+            std::uint64_t owner = 0;
+            TypeId type = nullptr;
+            std::size_t node = NumaTopology::AnyNode;
+            std::string tag;
+            void *instance = nullptr;
+            const ServiceDescriptor *descriptor = nullptr;
+        };
+
+        static const Slot *Find(std::uint64_t owner, TypeId type, const std::string &tag) {
+            auto &slot = Table()[Index(owner, type, tag)];
+            if (slot.epoch != ThreadResolveCache::Epoch().load(std::memory_order_acquire) || slot.owner != owner ||
+                slot.type != type || slot.tag != tag ||
+                (slot.node != NumaTopology::AnyNode && slot.node != NumaTopology::CurrentNode())) {
+                return nullptr;
+            }
+
+            return &slot;
         }
 
-        std::shared_ptr<T> CreateService() {
-            return this->creator();
+        static void Store(std::uint64_t epoch, std::uint64_t owner, TypeId type, const std::string &tag,
+                          std::size_t node, void *instance, const ServiceDescriptor *descriptor) {
+            auto &slot = Table()[Index(owner, type, tag)];
+            slot.epoch = epoch;
+            slot.owner = owner;
+            slot.type = type;
+            slot.node = node;
+            slot.tag = tag;
+            slot.instance = instance;
+            slot.descriptor = descriptor;
         }
 
     private:
-        CreatorSharedFnc<T> creator;
+        static std::array<Slot, Slots> &Table() {
+            thread_local std::array<Slot, Slots> table;
+            return table;
+        }
+
+        static std::size_t Index(std::uint64_t owner, TypeId type, const std::string &tag) {
+            std::size_t hash = std::hash<TypeId>()(type) ^ std::hash<std::string>()(tag);
+            hash ^= owner * 0x9E3779B97F4A7C15ull;
+            return (hash ^ (hash >> 17)) & (Slots - 1);
+        }
     };
 
     /**
-    * @class TypedServiceSingleton
-    *
-    * @brief The TypedServiceSingleton class is a singleton pattern implementation for a specific type of service.
+    * @class SingletonConstruction
     *
-    * This class provides a way to create, retrieve, and manage a single instance of a service of a given type. It
-    * follows the singleton pattern, ensuring that only one instance of the service exists throughout the lifetime
-    * of the application.
+    * @brief The SingletonConstruction class marks a singleton construction in progress on the current thread.
     *
-    * @tparam T The type of the service.
+    * Singletons resolved while a construction is in progress are recorded as dependencies of the singleton under
+    * construction, including the ones resolved through transient or scoped services it creates on the way. These
+    * are the services the instance may still use in its destructor.
     */
-    template<class T>
-    class TypedServiceSingleton : public BaseService {
+    class SingletonConstruction {
     public:
-        std::shared_ptr<T> instance;
+        SingletonConstruction() : previous(current) {
+            current = this;
+        }
 
-        void SetCreator(CreatorSharedFnc<T> crt) {
-            this->instance = crt();
+        ~SingletonConstruction() {
+            current = previous;
         }
 
-        std::shared_ptr<T> CreateService() {
-            return this->instance;
+        SingletonConstruction(const SingletonConstruction &) = delete;
+
+        SingletonConstruction &operator=(const SingletonConstruction &) = delete;
+
+        static void Record(const ServiceDescriptor *dependency) {
+            if (current) {
+                current->dependencies.push_back(dependency);
+            }
         }
 
+        std::vector<const ServiceDescriptor *> dependencies;
+
     private:
-        CreatorSharedFnc<T> creator;
+        static inline thread_local SingletonConstruction *current = nullptr;
+        SingletonConstruction *previous;
+    };
+
+    /**
+    * @struct TeardownReport
+    *
+    * @brief The TeardownReport struct describes the release of one singleton by Container::Shutdown.
+    */
+    struct TeardownReport {
+        std::string typeName;
+        std::string tag;
+        std::chrono::nanoseconds duration;
+
+        // false when references were still held outside the container, the instance outlived the shutdown
+        bool destroyed;
     };
 
     /**
@@ -107,9 +228,22 @@ namespace DI {
     * auto scope = Container::Instance().CreateScope();
     * auto scopedService = Container::Instance().ResolveScoped<IService>(scope);
     *
-    * @see TypedServiceSingleton
-    * @see TypedService
-    * @see BaseService
+    * Besides the process-wide instance, containers can be created on their own or as children of another container.
+    * A child sees every registration of its parent and may override any of them, without affecting the parent.
+    *
+    * auto tenant = Container::Instance().CreateChild();
+    * tenant->RegisterSingleton<IService, TenantService>();
+    *
+    * Errors are reported through RaiseError, which throws a std::runtime_error unless another handler is installed
+    * with SetErrorHandler. The container also builds with -fno-exceptions, where the default handler aborts, and with
+    * -fno-rtti, where types are identified by compile-time TypeInfo constants.
+    *
+    * The member templates are thin typed shims: they check the types, pick the vtables and casts of the
+    * implementation, and hand everything else over to a non-template core working on TypeId, see ContainerCore.hpp.
+    * The core is inline by default; linking the InjecttorCore library instead compiles it once for the whole program.
+    *
+    * @see ServiceDescriptor
+    * @see DescriptorSlab
     */
     class Container {
     public:
@@ -139,11 +273,229 @@ namespace DI {
         * Services registered as scoped are created once per scope and are shared among all consumers within that scope.
         */
         class Scope final {
+        public:
+            Scope() = default;
+
+            /**
+            * @param queue Where the instances go when the scope ends, nullptr to destroy them right away.
+            * @param resource Where the maps of the scope and its new instances are allocated from, nullptr for the
+            * default resource and the global allocator. It must outlive every instance created in the scope.
+            */
+            explicit Scope(std::shared_ptr<DisposalQueue> queue, std::pmr::memory_resource *resource = nullptr)
+                    : memory(resource ? resource : std::pmr::get_default_resource()), resource(resource),
+                      disposalQueue(std::move(queue)) {}
+
+            /**
+            * @brief Ends the scope.
+            *
+            * With deferred disposal, the instances are handed over to the container's disposal queue, except for the
+            * services registered with Disposal::Inline, and except when the queue is full. Everything else is
+            * destroyed right here.
+            */
+            ~Scope() {
+                if (!disposalQueue) {
+                    return;
+                }
+
+                std::vector<std::shared_ptr<void>> deferred;
+                Collect(services, inlineServices, deferred);
+                Collect(serviceSets, inlineSets, deferred);
+
+                disposalQueue->Post(deferred);
+            }
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+            /**
+            * @brief Reports the memory held by the scope: its maps, as registry, and its instances.
+            *
+            * Instances are counted by the size of their implementation, what they allocate themselves is not.
+            */
+            MemoryUsage MemoryStats() const {
+                return {memory.Bytes(MemoryCategory::Registry), 0, 0, 0, instanceBytes};
+            }
+
+        private:
+            friend Container;
+
+            CountingAllocator<char> Allocator() {
+                return {&memory, MemoryCategory::Registry};
+            }
+
+            static void Collect(CountedMap<TypeId, std::shared_ptr<void>> &instances,
+                                const CountedSet<TypeId> &keep, std::vector<std::shared_ptr<void>> &deferred) {
+                for (auto it = instances.begin(); it != instances.end();) {
+                    if (keep.count(it->first)) {
+                        ++it;
+                        continue;
+                    }
+
+                    deferred.push_back(std::move(it->second));
+                    it = instances.erase(it);
+                }
+            }
+
+            // Counts the maps below, which must go first
+            MemoryAccount memory;
+            std::size_t instanceBytes = 0;
+
+            // Where the instances are allocated from, nullptr for the global allocator
+            std::pmr::memory_resource *resource = nullptr;
+
+            std::shared_ptr<DisposalQueue> disposalQueue;
+            CountedMap<TypeId, std::shared_ptr<void>> services{Allocator()};
+            CountedMap<TypeId, std::shared_ptr<void>> serviceSets{Allocator()};
+            CountedSet<TypeId> inlineServices{Allocator()};
+            CountedSet<TypeId> inlineSets{Allocator()};
+        };
+
+        /**
+        * @class Batch
+        *
+        * @brief The Batch class collects registrations and commits them to the Container at once.
+        *
+        * Registering thousands of services one by one repeatedly grows the maps and allocates every entry on its own.
+        * A batch knows everything up front: on commit, the tables are sized once and the descriptors are allocated next
+        * to each other in a single slab chunk. When any registration is already registered, in the batch or in the
+        * Container, or any singleton fails to construct, the commit fails before anything is registered.
+        *
+        * Singletons are constructed before anything gets published, so they can resolve services registered
+        * beforehand but not services of their own batch. Every shard the batch registers into is then locked, and the
+        * whole batch checked again, before anything is published. A registration made meanwhile on another thread for
+        * the same type and tag makes the commit fail with nothing published, and the singletons of the batch released.
+        * Otherwise the whole batch is published, shard by shard, so resolves running meanwhile may see part of it.
+        *
+        * auto batch = Container::Instance().CreateBatch();
+        * batch.Singleton<ILogger, Logger>()
+        *      .Transient<IDatabase, MySQLDatabase>("MySQL")
+        *      .Scoped<IUnitOfWork, UnitOfWork>();
+        * batch.Commit();
+        */
+        class Batch final {
+        public:
+            template<class TInterface, class TImplementation>
+            Batch &Singleton(std::string tag = "") {
+                static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                              "TImplementation should derive from TInterface");
+
+                return Add<TInterface, TImplementation, Lifetime::Singleton>(std::move(tag), Disposal::Deferred);
+            }
+
+            template<class TInterface, class TImplementation>
+            Batch &Transient(std::string tag = "") {
+                static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                              "TImplementation should derive from TInterface");
+
+                return Add<TInterface, TImplementation, Lifetime::Transient>(std::move(tag), Disposal::Deferred);
+            }
+
+            template<class TInterface, class TImplementation>
+            Batch &Scoped(std::string tag = "", Disposal disposal = Disposal::Deferred) {
+                static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                              "TImplementation should derive from TInterface");
+
+                return Add<TInterface, TImplementation, Lifetime::Scoped>(std::move(tag), disposal);
+            }
+
+            /**
+            * @brief Registers every collected service in the Container.
+            *
+            * @throw std::runtime_error if a service is registered twice, in the batch or in the Container.
+            */
+            void Commit() {
+                container.CommitBatch(bindings);
+                bindings.clear();
+            }
+
         private:
             friend Container;
-            std::unordered_map<std::string, std::shared_ptr<void>> services;
+
+            struct Binding {
+                Lifetime lifetime;
+                TypeId type;
+                std::string tag;
+                Disposal disposal;
+                const ServiceVTable *vtable;
+            };
+
+            explicit Batch(Container &container) : container(container) {}
+
+            template<class TInterface, class TImplementation, Lifetime lifetime>
+            Batch &Add(std::string tag, Disposal disposal) {
+                bindings.push_back({lifetime, TypeIdOf<TInterface>(), std::move(tag), disposal,
+                                    Container::VTableFor<TInterface, TImplementation, lifetime>()});
+                return *this;
+            }
+
+            Container &container;
+            std::vector<Binding> bindings;
         };
 
+        /**
+        * @brief Constructs an empty, standalone container.
+        *
+        * Standalone containers are independent of Instance(), which makes them suited for tests and for
+        * components that must not share registrations with the rest of the process.
+        */
+        Container() = default;
+
+        /**
+        * @brief Constructs an empty, standalone container whose maps and descriptors are allocated from a resource.
+        *
+        * Children inherit the resource, which must outlive the container and its children; nullptr stands for the
+        * default resource. Instances are not allocated from it: see CreateScope and ResolveTransient for those.
+        */
+        explicit Container(std::pmr::memory_resource *resource);
+
+        /**
+        * @brief Detaches the container from its parent and its children.
+        *
+        * Children keep the registrations they inherited, the services are shared and stay alive.
+        */
+        ~Container();
+
+        /**
+        * @brief Creates a child container.
+        *
+        * The child starts with a flattened view of every registration of this container, sharing the same
+        * service descriptors and singleton instances, nothing is copied but the index. Registrations made on the child
+        * override the inherited ones for the same type and tag and are not visible to this container. Registrations
+        * made on this container later on are pushed to its children, unless overridden there, so resolving from a
+        * child is a single lookup and never walks the parent chain.
+        *
+        * The parent has to outlive the registrations made on it afterwards for them to reach the child, and the child
+        * must not be destroyed while registrations are running on the parent.
+        *
+        * @return std::shared_ptr<Container> The newly created child container.
+        */
+        std::shared_ptr<Container> CreateChild();
+
+        /**
+        * @brief Creates a batch collecting registrations to commit at once.
+        *
+        * @see Batch
+        */
+        Batch CreateBatch() {
+            return Batch(*this);
+        }
+
+        /**
+        * @brief Turns the per-thread resolve cache on or off for this container.
+        *
+        * When enabled, single transient, scoped and factory resolves first look into a small thread-local table, so hot
+        * services are found without touching the maps shared by all the threads. Singletons do not need it, their
+        * flat table already holds the instances inline. Any registration, on any container, invalidates every cached
+        * entry. The cache is off by default. Children inherit the setting in effect when they are created. It may be
+        * toggled while other threads resolve, which pick up the change on one of their next resolves.
+        *
+        * @param enabled Whether the resolves of this container go through the thread-local cache.
+        */
+        void EnableThreadCache(bool enabled = true) {
+            threadCache.store(enabled, std::memory_order_relaxed);
+        }
+
         /**
         * deleted constructor
         */
@@ -159,8 +511,8 @@ namespace DI {
         *
         * This function is responsible for registering a singleton service in the Container. The provided types are used to ensure
         * that the implementation derives from the interface. The function checks if the service has already been registered and throws
-        * an exception if it has. If the service has not been registered, it creates a TypedServiceSingleton instance, sets the creator
-        * function, and adds it to the singletonServices map.
+        * an exception if it has. If the service has not been registered, it constructs the instance, stores it in a
+        * descriptor allocated from the container's slab, and adds it to the singletonServices map.
         *
         * @tparam TInterface The interface type of the service.
         * @tparam TImplementation The implementation type of the service.
@@ -172,19 +524,59 @@ namespace DI {
             static_assert(std::is_base_of<TInterface, TImplementation>::value,
                           "TImplementation should derive from TInterface");
 
-            std::string typeName = typeid(TInterface).name();
-            auto mapIt = singletonServices.find(typeName);
-            if (mapIt != singletonServices.end()) {
-                auto tagIt = mapIt->second.find(tag);
-                if (tagIt != mapIt->second.end()) {
-                    throw std::runtime_error("Singleton Service already registered");
-                }
-            }
+            Register(&Container::singletonServices, TypeIdOf<TInterface>(), tag,
+                     VTableFor<TInterface, TImplementation, Lifetime::Singleton>(), Disposal::Deferred,
+                     "Singleton Service already registered");
+        }
+
+        /**
+        * @brief Registers a singleton service replicated on every NUMA node.
+        *
+        * Meant for read-mostly singletons resolved from every core, such as configurations, lookup tables or loggers.
+        * One instance is constructed per node, on a thread bound to the node, and allocated on cache lines of its own
+        * along with its control block, see ReplicaSet. ResolveSingleton hands out the replica of the node the calling
+        * thread runs on. The replicas are independent: state written to one is not seen by the others.
+        * ResolveAllSingletons returns the first replica. On a single-node machine this is a plain singleton, built on
+        * the calling thread; see NumaTopology to simulate nodes.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @tparam TImplementation The implementation type of the service.
+        *
+        * @throw std::runtime_error if the singleton service is already registered.
+        */
+        template<class TInterface, class TImplementation>
+        void RegisterSingletonPerNode(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+
+            CheckLifetimes<TImplementation, Lifetime::Singleton>();
+            Register(&Container::singletonServices, TypeIdOf<TInterface>(), tag,
+                     &PerNodeVTableOf<TInterface, TImplementation>, Disposal::Deferred,
+                     "Singleton Service already registered");
+        }
 
-            auto service = std::make_shared<TypedServiceSingleton<TInterface>>();
-            service->SetCreator([] { return std::make_shared<TImplementation>(); });
+        /**
+        * @brief Registers a thread-local service in the Container.
+        *
+        * Each thread resolving the service gets an instance of its own, constructed on first use and kept in a slot of
+        * the thread's ThreadLocalStore, which suits per-thread buffers, random generators or connection handles. The
+        * instances are released when their thread exits, or later if someone still holds them; their destructors must
+        * not resolve thread-local services. Shutdown leaves them to their threads. The slot of the registration is
+        * recycled once it is replaced or its container destroyed, see ThreadSlot.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @tparam TImplementation The implementation type of the service.
+        *
+        * @throw std::runtime_error if the thread-local service is already registered.
+        */
+        template<class TInterface, class TImplementation>
+        void RegisterThreadLocal(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
 
-            singletonServices[typeName][tag] = service;
+            Register(&Container::threadLocalServices, TypeIdOf<TInterface>(), tag,
+                     VTableFor<TInterface, TImplementation, Lifetime::ThreadLocal>(), Disposal::Deferred,
+                     "Thread-local Service already registered");
         }
 
         /**
@@ -193,8 +585,8 @@ namespace DI {
         *
         * This function is responsible for registering a transient service in the Container. The provided types are used to ensure
         * that the implementation derives from the interface. The function checks if the service has already been registered and throws
-        * an exception if it has. If the service has not been registered, it creates a TypedService instance, sets the creator
-        * function, and adds it to the transientServices map.
+        * an exception if it has. If the service has not been registered, it allocates a descriptor pointing at the
+        * vtable of the implementation, and adds it to the transientServices map.
         *
         * @tparam TInterface The interface type of the service.
         * @tparam TImplementation The implementation type of the service.
@@ -206,21 +598,9 @@ namespace DI {
             static_assert(std::is_base_of<TInterface, TImplementation>::value,
                           "TImplementation should derive from TInterface");
 
-            std::string typeName = typeid(TInterface).name();
-            auto mapIt = transientServices.find(typeName);
-
-            if (mapIt != transientServices.end()) {
-                auto tagIt = mapIt->second.find(tag);
-
-                if (tagIt != mapIt->second.end()) {
-                    throw std::runtime_error("Transient service already registered with this tag");
-                }
-            }
-
-            auto service = std::make_shared<TypedService<TInterface>>();
-            service->SetCreator([] { return std::make_shared<TImplementation>(); });
-
-            transientServices[typeName][tag] = service;
+            Register(&Container::transientServices, TypeIdOf<TInterface>(), tag,
+                     VTableFor<TInterface, TImplementation, Lifetime::Transient>(), Disposal::Deferred,
+                     "Transient service already registered with this tag");
         }
 
         /**
@@ -229,157 +609,1053 @@ namespace DI {
         *
         * This function is responsible for registering a scoped service in the Container. The provided types are used to ensure
         * that the implementation derives from the interface. The function checks if the service has already been registered and throws
-        * an exception if it has. If the service has not been registered, it creates a TypedService instance, sets the creator
-        * function, and adds it to the scopedServices map.
+        * an exception if it has. If the service has not been registered, it allocates a descriptor pointing at the
+        * vtable of the implementation, and adds it to the scopedServices map.
         *
         * @tparam TInterface The interface type of the service.
         * @tparam TImplementation The implementation type of the service.
+        * @param disposal Disposal::Inline to always destroy the instances when their scope ends, even in scopes
+        * created with deferred disposal, for services that must be released synchronously.
         *
         * @throw std::runtime_error if the scoped service is already registered.
         */
         template<class TInterface, class TImplementation>
-        void RegisterScoped(std::string tag = "") {
+        void RegisterScoped(std::string tag = "", Disposal disposal = Disposal::Deferred) {
             static_assert(std::is_base_of<TInterface, TImplementation>::value,
                           "TImplementation should derive from TInterface");
 
-            std::string typeName = typeid(TInterface).name();
-            auto mapIt = scopedServices.find(typeName);
-            if (mapIt != scopedServices.end()) {
-                auto tagIt = mapIt->second.find(tag);
-                if(tagIt != mapIt->second.end()){
-                    throw std::runtime_error("Scoped Service is already registered");
-                }
-            }
+            Register(&Container::scopedServices, TypeIdOf<TInterface>(), tag,
+                     VTableFor<TInterface, TImplementation, Lifetime::Scoped>(), disposal,
+                     "Scoped Service is already registered");
+        }
+
 
-            auto service = std::make_shared<TypedService<TInterface>>();
-            service->SetCreator([] { return std::make_shared<TImplementation>(); });
+        /**
+        * @brief Registers a scoped service whose instances are recycled across scopes.
+        *
+        * Meant for services that are expensive to construct but cheap to reset, a unit of work holding a database
+        * connection for instance. When a scope ends, its instance is reset through its Reset() member function and
+        * kept in a pool; the next scope gets a reset instance from the pool rather than a new one. With deferred
+        * disposal the reset runs on the disposal thread. Instances whose Reset() throws are destroyed.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @tparam TImplementation The implementation type of the service, with a void Reset() member function.
+        * @param capacity The maximum number of idle instances kept in the pool, the others are destroyed.
+        * @param disposal How the instances are disposed of, and therefore reset, when their scope ends.
+        *
+        * @throw std::runtime_error if the scoped service is already registered.
+        */
+        template<class TInterface, class TImplementation>
+        void RegisterScopedReusable(std::string tag = "", std::size_t capacity = InstancePool::DefaultCapacity,
+                                    Disposal disposal = Disposal::Deferred) {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+            static_assert(requires(TImplementation &service) { service.Reset(); },
+                          "TImplementation should have a Reset() member function");
 
-            scopedServices[typeName][tag] = service;
+            CheckLifetimes<TImplementation, Lifetime::Scoped>();
+            Register(&Container::scopedServices, TypeIdOf<TInterface>(), tag,
+                     &PooledVTableOf<TInterface, TImplementation>, disposal,
+                     "Scoped Service is already registered", MakeInstancePool<TImplementation>(capacity, memory));
         }
 
+        /**
+        * @brief Constructs instances of a reusable scoped service ahead of time.
+        *
+        * @param count The number of idle instances wanted in the pool, bounded by its capacity.
+        * @throw std::runtime_error if the service is not registered as reusable.
+        */
+        template<typename TInterface>
+        void ReserveScopedPool(std::size_t count, const std::string &tag = "") {
+            PoolOf(TypeIdOf<TInterface>(), tag)->Reserve(count);
+        }
 
         /**
-        * @brief Resolves a singleton service from the Container.
+        * @brief Destroys the idle instances of a reusable scoped service beyond the given number.
         *
-        * This function is responsible for resolving a singleton service from the Container. It looks for the service type in the
-        * singletonServices map. If the service is not found, an exception is thrown. If the service is found, it is casted to the
-        * TypedServiceSingleton type and the CreateService function is called to retrieve the instance of the service.
+        * The high-water mark restarts from the instances currently in use, so that the next trim can be sized on
+        * the peak observed in between.
         *
-        * @tparam TInterface The interface type of the service.
-        * @return std::shared_ptr<TInterface> The resolved singleton service.
-        * @throw std::runtime_error if the singleton service is not found in the Container.
+        * @return std::size_t The number of instances destroyed.
+        * @throw std::runtime_error if the service is not registered as reusable.
         */
         template<typename TInterface>
-        std::shared_ptr<TInterface> ResolveSingleton(std::string tag = "") {
-            std::string typeName = typeid(TInterface).name();
+        std::size_t TrimScopedPool(std::size_t keep = 0, const std::string &tag = "") {
+            return PoolOf(TypeIdOf<TInterface>(), tag)->Trim(keep);
+        }
 
-            auto map = singletonServices.find(typeName);
-            if (map == singletonServices.end()) {
-                throw std::runtime_error("Singleton Service not found: " + typeName);
-            }
+        /**
+        * @return PoolStats The pool activity of a reusable scoped service.
+        * @throw std::runtime_error if the service is not registered as reusable.
+        */
+        template<typename TInterface>
+        PoolStats ScopedPoolStats(const std::string &tag = "") {
+            return PoolOf(TypeIdOf<TInterface>(), tag)->Stats();
+        }
 
-            auto it = map->second.find(tag);
-            if (it == map->second.end()) {
-                throw std::runtime_error("Singleton Service not found: " + typeName);
-            }
+        /**
+        * @brief Registers a factory that builds a service from runtime arguments, also known as assisted injection.
+        *
+        * The implementation is constructed with the arguments handed to Create, its other dependencies are resolved
+        * from the container by its constructor as usual. Factories are looked up by interface and by the decayed types
+        * of the arguments, the arguments are forwarded to the constructor through a plain function pointer, without
+        * any heap allocation nor type-erased call wrapper. Decorators registered beforehand for the interface wrap the
+        * created instances.
+        *
+        * Text is taken as std::string: Create hands string literals and character pointers over as std::string, so
+        * factories cannot be registered with character pointers.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @tparam TImplementation The implementation type of the service.
+        * @tparam Args The types of the runtime arguments, as accepted by the constructor.
+        *
+        * @throw std::runtime_error if a factory with the same arguments is already registered with this tag.
+        */
+        template<class TInterface, class TImplementation, class... Args>
+        void RegisterFactory(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+            static_assert((!IsCharacterPointer<Args> && ...),
+                          "Factories take text as std::string: Create converts literals and char pointers to it");
+            static_assert(std::is_constructible<TImplementation, std::decay_t<Args> &&...>::value,
+                          "TImplementation should be constructible from Args");
 
-            auto val = std::static_pointer_cast<TypedServiceSingleton<TInterface>>(it->second);
-            return val->CreateService();
+            AddFactory(TypeIdOf<FactorySignature<TInterface, std::decay_t<Args>...>>(), TypeIdOf<TInterface>(), tag,
+                       &FactoryVTableOf<TImplementation>,
+                       reinterpret_cast<ErasedFnc>(&Construct<TInterface, TImplementation, std::decay_t<Args>...>));
         }
 
         /**
-        * @brief Resolves a transient service from the Container.
+        * @brief Creates a service through the factory registered for the given runtime arguments.
         *
-        * This function is responsible for resolving a transient service from the Container. It looks for the service type in the
-        * transientServices map. If the service is not found, an exception is thrown. If the service is found, it is casted to the
-        * TypedService type for the given interface and the CreateService function is called to retrieve the instance of the service.
+        * Rvalue arguments are moved all the way to the constructor; lvalue arguments are copied once, as the
+        * constructor takes ownership of what it is given. Use std::ref to hand a reference through. String literals
+        * and character pointers are handed over as std::string, see RegisterFactory.
         *
         * @tparam TInterface The interface type of the service.
-        * @return std::shared_ptr<TInterface> The resolved transient service.
-        * @throw std::runtime_error if the transient service is not found in the Container.
+        * @param args The runtime arguments forwarded to the constructor of the implementation.
+        * @return std::shared_ptr<TInterface> The newly created service.
+        * @throw std::runtime_error if no factory is registered for these arguments.
         */
-        template<typename TInterface>
-        std::shared_ptr<TInterface> ResolveTransient(std::string tag = "") {
-            std::string typeName = typeid(TInterface).name();
-            auto map = transientServices.find(typeName);
+        template<typename TInterface, typename... Args>
+        std::shared_ptr<TInterface> Create(Args &&... args) {
+            return CreateTagged<TInterface>("", std::forward<Args>(args)...);
+        }
 
-            if (map == transientServices.end()) {
-                throw std::runtime_error("Transient Service not found: " + typeName);
-            }
+        /**
+        * @brief Creates a service through the factory registered with a tag for the given runtime arguments.
+        *
+        * @see Create
+        */
+        template<typename TInterface, typename... Args>
+        std::shared_ptr<TInterface> CreateTagged(const std::string &tag, Args &&... args) {
+            EpochReclaimer::ReadGuard guard;
+            using Signature = FactorySignature<TInterface, FactoryParameter<Args>...>;
 
-            auto it = map->second.find(tag);
-            if (it == map->second.end()) {
-                throw std::runtime_error("Transient Service not found: " + typeName);
-            }
+            auto &service = FactoryOf(TypeIdOf<Signature>(), TypeIdOf<TInterface>(), tag);
 
-            auto val = std::static_pointer_cast<TypedService<TInterface>>(it->second);
-            return val->CreateService();
+            auto factory = reinterpret_cast<std::shared_ptr<TInterface> (*)(FactoryParameter<Args> &&...)>(
+                    service.factory);
+            return ApplyDecorators<TInterface>(factory(FactoryArgument<Args>(args)...), service.decorators.get());
         }
 
         /**
-        * @brief Creates a new scope in the Container.
+        * @brief Registers a decorator around every implementation of an interface.
         *
-        * This function creates a new scope in the Container. A scope is used to manage the lifetime and sharing of
-        * scoped services. Scoped services are created once per scope and are shared among all consumers within that
-        * scope. The scope is represented by a std::shared_ptr<Scope> object.
+        * The decorator is constructed with the instance it wraps and must implement the same interface, so that
+        * cross-cutting concerns such as metrics, retries or caching can be layered on top of a service without the
+        * service or its consumers knowing about it. The decorator applies to every lifetime and tag:
         *
-        * @return std::shared_ptr<Scope> The newly created scope.
+        * - registrations already visible in this container are replaced by decorated ones, singletons are wrapped
+        *   right away, once, and resolving them costs nothing more than before;
+        * - registrations made on this container afterwards are decorated as they are registered.
+        *
+        * Decorators nest in registration order, the last one registered is the outermost. Children created afterwards
+        * inherit the decorators of this container. Registrations made on other threads while the decorator is being
+        * registered may or may not be decorated.
+        *
+        * Decorating a registration a child inherited makes the decorated one local to the child, which cuts it from
+        * its parent: replacing the registration in the parent afterwards no longer reaches the child, the child keeps
+        * the decorated one until it replaces it itself. Register the decorator on the parent to decorate both.
+        *
+        * @tparam TInterface The interface type of the decorated services.
+        * @tparam TDecorator The decorator type, constructible from a std::shared_ptr<TInterface>.
         */
-        std::shared_ptr<Scope> CreateScope() {
-            return std::make_shared<Scope>();
+        template<class TInterface, class TDecorator>
+        void RegisterDecorator() {
+            static_assert(std::is_base_of<TInterface, TDecorator>::value,
+                          "TDecorator should derive from TInterface");
+            static_assert(std::is_constructible<TDecorator, std::shared_ptr<TInterface>>::value,
+                          "TDecorator should be constructible from the decorated std::shared_ptr<TInterface>");
+
+            Decorate(TypeIdOf<TInterface>(), reinterpret_cast<ErasedFnc>(&DecorateInstance<TInterface, TDecorator>),
+                     &WrapSingleton<TInterface>);
         }
 
         /**
-        * @brief Resolves a scoped service from the Container.
+        * @brief Replaces the implementation registered for an interface and tag, while the container is in use.
         *
-        * This function is responsible for resolving a scoped service from the Container.
-        * It checks if the service has already been registered in the provided scope. If it has,
-        * it returns an empty std::weak_ptr. If the service has not been registered, it looks for
-        * the service type in the scopedServices map. If the service is not found, an exception is
-        * thrown. If the service is found, it is casted to the TypedService type for the given interface,
-        * and the CreateService function is called to retrieve the instance of the service. The new
-        * service is then added to the services map of the provided scope, and a std::weak_ptr to the
-        * service is returned.
+        * The registration is swapped with the same lifetime, in every lifetime it is registered with that
+        * TImplementation may have: the lifetimes its declared dependencies would not outlive are left alone. The new
+        * binding is published with atomic stores, so a resolve running concurrently gets either the old or the new
+        * implementation, never anything in between, and later resolves get the new one. A new singleton is
+        * constructed before it is published, the old one keeps serving meanwhile. Decorators registered for the
+        * interface apply to the new implementation as well.
         *
-        * @param scope The scope in which the service is resolved.
+        * The old registration, and the old singleton instance, are released once no resolve in flight can still be
+        * using them; consumers holding the old instance keep it alive as long as they need. Replacing a registration
+        * inherited from a parent overrides it in this container only.
         *
-        * @return std::weak_ptr<TInterface> A weak_ptr to the resolved scoped service.
+        * Replace is meant for reconfiguration at runtime. Like any registration, it may run concurrently with other
+        * registrations and with resolves; concurrent replacements of the same interface and tag are applied in an
+        * unspecified order. ReplaceSingleton, ReplaceTransient, ReplaceScoped and ReplaceThreadLocal replace a single
+        * lifetime.
         *
-        * @throw std::runtime_error if the service was not registered.
+        * @tparam TInterface The interface type of the service.
+        * @tparam TImplementation The new implementation type of the service.
+        *
+        * @throw std::runtime_error if nothing is registered for this interface and tag, in the lifetimes
+        * TImplementation may have.
         */
-        template<typename TInterface>
-        std::weak_ptr<TInterface> ResolveScoped(std::shared_ptr<Scope> &scope, std::string tag = "") {
-            std::string typeName = typeid(TInterface).name();
+        template<class TInterface, class TImplementation>
+        void Replace(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
 
-            // If the scope already has the service, we don't create a new one
-            if (scope->services.count(typeName))
-                return {};
+            bool replaced = false;
+            if constexpr (CanHave<TImplementation, Lifetime::Singleton>) {
+                replaced |= ReplaceAs<TInterface, TImplementation, Lifetime::Singleton>(tag);
+            }
 
-            auto map = scopedServices.find(typeName);
-            if (map == scopedServices.end()) {
-                throw std::runtime_error("Service was not registered: " + typeName);
+            if constexpr (CanHave<TImplementation, Lifetime::Transient>) {
+                replaced |= ReplaceAs<TInterface, TImplementation, Lifetime::Transient>(tag);
             }
 
-            auto it = map->second.find(tag);
-            if (it == map->second.end()) {
-                throw std::runtime_error("Service was not found: " + typeName);
+            if constexpr (CanHave<TImplementation, Lifetime::Scoped>) {
+                replaced |= ReplaceAs<TInterface, TImplementation, Lifetime::Scoped>(tag);
             }
 
-            auto val = std::static_pointer_cast<TypedService<TInterface>>(it->second);
-            auto newService = val->CreateService();
-            scope->services[typeName] = newService;
+            if constexpr (CanHave<TImplementation, Lifetime::ThreadLocal>) {
+                replaced |= ReplaceAs<TInterface, TImplementation, Lifetime::ThreadLocal>(tag);
+            }
 
-            return std::weak_ptr<TInterface>(newService);
+            if (!replaced) {
+                NotFound("Service to replace was not found: ", TypeIdOf<TInterface>());
+            }
         }
 
-    private:
-        Container() = default;
+        /**
+        * @brief Replaces the implementation of a singleton service, while the container is in use.
+        *
+        * @see Replace
+        *
+        * @throw std::runtime_error if no singleton is registered for this interface and tag.
+        */
+        template<class TInterface, class TImplementation>
+        void ReplaceSingleton(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
 
-        std::unordered_map<std::string, MapType> scopedServices;
-        std::unordered_map<std::string, MapType> singletonServices;
-        std::unordered_map<std::string, MapType> transientServices;
-    };
+            if (!ReplaceAs<TInterface, TImplementation, Lifetime::Singleton>(tag)) {
+                NotFound("Singleton Service to replace was not found: ", TypeIdOf<TInterface>());
+            }
+        }
 
-}
+        /**
+        * @brief Replaces the implementation of a transient service, while the container is in use.
+        *
+        * @see Replace
+        *
+        * @throw std::runtime_error if no transient service is registered for this interface and tag.
+        */
+        template<class TInterface, class TImplementation>
+        void ReplaceTransient(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+
+            if (!ReplaceAs<TInterface, TImplementation, Lifetime::Transient>(tag)) {
+                NotFound("Transient Service to replace was not found: ", TypeIdOf<TInterface>());
+            }
+        }
+
+        /**
+        * @brief Replaces the implementation of a scoped service, while the container is in use.
+        *
+        * A reusable scoped service stays reusable when TImplementation has a Reset() member function.
+        *
+        * @see Replace
+        *
+        * @throw std::runtime_error if no scoped service is registered for this interface and tag.
+        */
+        template<class TInterface, class TImplementation>
+        void ReplaceScoped(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+
+            if (!ReplaceAs<TInterface, TImplementation, Lifetime::Scoped>(tag)) {
+                NotFound("Scoped Service to replace was not found: ", TypeIdOf<TInterface>());
+            }
+        }
+
+        /**
+        * @brief Replaces the implementation of a thread-local service, while the container is in use.
+        *
+        * Threads construct an instance of the new implementation on their next resolve. The instances of the old one
+        * are left to the threads holding them, they are released when those threads exit at the latest.
+        *
+        * @see Replace
+        *
+        * @throw std::runtime_error if no thread-local service is registered for this interface and tag.
+        */
+        template<class TInterface, class TImplementation>
+        void ReplaceThreadLocal(std::string tag = "") {
+            static_assert(std::is_base_of<TInterface, TImplementation>::value,
+                          "TImplementation should derive from TInterface");
+
+            if (!ReplaceAs<TInterface, TImplementation, Lifetime::ThreadLocal>(tag)) {
+                NotFound("Thread-local Service to replace was not found: ", TypeIdOf<TInterface>());
+            }
+        }
+
+        /**
+        * @brief Releases the replaced registrations no resolve can still be using.
+        *
+        * Replace already does so, this is only needed to release what was still in use back then.
+        *
+        * @return std::size_t The number of objects still waiting for resolves in flight to complete.
+        */
+        std::size_t Reclaim() {
+            return reclaimer.Collect();
+        }
+
+        /**
+        * @brief Checks the dependencies declared by the registered implementations against the registrations.
+        *
+        * Lifetime inversions between declared dependencies are already rejected at compile time, see DependsOn. What
+        * the compiler cannot see is how the dependencies end up registered: this pass checks that each of them is
+        * registered, here or in a parent, with the lifetime its consumer expects. It is meant to run once, after the
+        * registrations, nothing is checked when resolving.
+        *
+        * @throw std::runtime_error listing every dependency that is not registered as declared.
+        */
+        void Validate() const;
+
+        /**
+        * @brief Resolves a singleton service from the Container.
+        *
+        * This function is responsible for resolving a singleton service from the Container. It looks for the service type and tag in
+        * the flat singleton table, whose slots hold the instance inline. If the service is not found, an exception is thrown.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return std::shared_ptr<TInterface> The resolved singleton service.
+        * @throw std::runtime_error if the singleton service is not found in the Container.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> ResolveSingleton(std::string tag = "") {
+            return std::static_pointer_cast<TInterface>(Resolve(Lifetime::Singleton, TypeIdOf<TInterface>(), tag, true));
+        }
+
+        /**
+        * @brief Resolves a singleton service from the Container, if it is registered.
+        *
+        * Unlike ResolveSingleton, a missing service is no error: nothing is thrown and no message is built, which
+        * suits optional dependencies and lookups driven by request data.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return std::shared_ptr<TInterface> The resolved singleton service, nullptr when it is not registered.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> TryResolveSingleton(const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(Resolve(Lifetime::Singleton, TypeIdOf<TInterface>(), tag, false));
+        }
+
+        /**
+        * @brief Borrows a singleton service from the Container, without taking ownership of it.
+        *
+        * Unlike ResolveSingleton, no shared_ptr is copied: no reference count is incremented nor decremented, so
+        * callers resolving the same singleton from many cores write to no shared cache line. Repeated borrows are
+        * served by a thread-local BorrowCache, without even entering a read guard. Per-node singletons lend the
+        * replica of the calling thread's node.
+        *
+        * The reference stays valid only until the registration is replaced, by Replace or RegisterDecorator, which
+        * may release the instance as soon as it is published; Shutdown and the destruction of the container end it
+        * as well. Keep a ResolveSingleton shared_ptr instead across reconfigurations.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return TInterface& The singleton instance.
+        * @throw std::runtime_error if the singleton service is not found in the Container.
+        */
+        template<typename TInterface>
+        TInterface &ResolveSingletonRef(const std::string &tag = "") {
+            return *static_cast<TInterface *>(Borrow(TypeIdOf<TInterface>(), tag, true));
+        }
+
+        /**
+        * @brief Borrows a singleton service from the Container, if it is registered.
+        *
+        * @see ResolveSingletonRef
+        *
+        * @return TInterface* The singleton instance, not owned by the caller; nullptr when it is not registered.
+        */
+        template<typename TInterface>
+        TInterface *TryResolveSingletonRef(const std::string &tag = "") {
+            return static_cast<TInterface *>(Borrow(TypeIdOf<TInterface>(), tag, false));
+        }
+
+        /**
+        * @brief Resolves a transient service from the Container.
+        *
+        * This function is responsible for resolving a transient service from the Container. It looks for the service type in the
+        * transientServices map. If the service is not found, an exception is thrown. If the service is found, a new instance is created
+        * through the vtable of its descriptor.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return std::shared_ptr<TInterface> The resolved transient service.
+        * @throw std::runtime_error if the transient service is not found in the Container.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> ResolveTransient(std::string tag = "") {
+            return std::static_pointer_cast<TInterface>(Resolve(Lifetime::Transient, TypeIdOf<TInterface>(), tag, true));
+        }
+
+        /**
+        * @brief Resolves the instance of a thread-local service belonging to the calling thread.
+        *
+        * The first resolve on a thread constructs the instance, the next ones find it in the thread's slot.
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return std::shared_ptr<TInterface> The instance of the calling thread.
+        * @throw std::runtime_error if the thread-local service is not found in the Container.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> ResolveThreadLocal(const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(Resolve(Lifetime::ThreadLocal, TypeIdOf<TInterface>(), tag, true));
+        }
+
+        /**
+        * @brief Resolves the instance of a thread-local service belonging to the calling thread, if it is registered.
+        *
+        * @see TryResolveSingleton
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> TryResolveThreadLocal(const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(
+                    Resolve(Lifetime::ThreadLocal, TypeIdOf<TInterface>(), tag, false));
+        }
+
+        /**
+        * @brief Counts the thread-local instances of this container held by each live thread.
+        *
+        * @return std::vector<ThreadInstances> One entry per thread holding at least one instance.
+        */
+        std::vector<ThreadInstances> ThreadLocalInstances() const;
+
+        /**
+        * @brief Resolves a transient service, allocating the new instance from a memory resource.
+        *
+        * The instance and its control block come from the resource, which must outlive the instance. Decorators and
+        * the dependencies the constructor resolves are allocated as usual.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> ResolveTransient(std::pmr::memory_resource *resource, const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(
+                    Resolve(Lifetime::Transient, TypeIdOf<TInterface>(), tag, true, resource));
+        }
+
+        /**
+        * @brief Resolves a transient service from the Container, if it is registered.
+        *
+        * @see TryResolveSingleton
+        *
+        * @tparam TInterface The interface type of the service.
+        * @return std::shared_ptr<TInterface> A new instance of the service, nullptr when it is not registered.
+        */
+        template<typename TInterface>
+        std::shared_ptr<TInterface> TryResolveTransient(const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(Resolve(Lifetime::Transient, TypeIdOf<TInterface>(), tag, false));
+        }
+
+        /**
+        * @brief Creates a new scope in the Container.
+        *
+        * This function creates a new scope in the Container. A scope is used to manage the lifetime and sharing of
+        * scoped services. Scoped services are created once per scope and are shared among all consumers within that
+        * scope. The scope is represented by a std::shared_ptr<Scope> object.
+        *
+        * With Disposal::Deferred, the scoped instances are destroyed on a background thread once the scope ends,
+        * which takes their destructors off the thread ending the scope, a request thread for instance.
+        *
+        * A scope given a memory resource is allocated from it, along with its maps and the scoped instances it
+        * creates, an arena per request or a NUMA-local resource per worker for instance. Pooled instances come from
+        * their pool. The resource must outlive every instance, including the ones still waiting for deferred disposal.
+        *
+        * @param disposal How the scoped instances are disposed of when the scope ends.
+        * @param resource Where the scope and its instances are allocated from, nullptr for the global allocator.
+        *
+        * @return std::shared_ptr<Scope> The newly created scope.
+        */
+        std::shared_ptr<Scope> CreateScope(Disposal disposal = Disposal::Inline,
+                                           std::pmr::memory_resource *resource = nullptr);
+
+        /**
+        * @brief Sets how many instances may wait for deferred disposal.
+        *
+        * When the limit is reached, ending scopes destroy their instances themselves until the queue drains.
+        *
+        * @param capacity The maximum number of instances waiting to be destroyed.
+        */
+        void SetDisposalCapacity(std::size_t capacity);
+
+        /**
+        * @brief Blocks until every instance handed over for deferred disposal has been destroyed.
+        *
+        * Meant for shutdown, to make sure every scoped service is gone before the process tears down.
+        */
+        void FlushDisposals();
+
+        /**
+        * @brief Destroys the singletons of the container in reverse dependency order.
+        *
+        * The dependencies are the singletons each singleton resolved while it was constructed. A singleton is released
+        * only after every singleton depending on it, so destructors can still use what they were given, an ILogger for
+        * instance, or resolve it again. Singletons that do not depend on each other are released in waves, each wave in
+        * parallel when requested. A wave is unregistered right before it is released, once no resolve in flight can
+        * still reach it, and its descriptors go back to the slab. Afterwards the container holds no singleton anymore
+        * and resolving one throws.
+        *
+        * Singletons inherited from a parent are removed from this container but left alive, they belong to the
+        * parent. Children should be shut down before their parent.
+        *
+        * @param parallel Whether independent singletons are released concurrently.
+        * @return std::vector<TeardownReport> The released singletons, in release order, with their teardown time.
+        */
+        std::vector<TeardownReport> Shutdown(bool parallel = true);
+
+        /**
+        * @brief Reports the memory held by the container, by category.
+        *
+        * The registries, singleton tables and bookkeeping maps allocate through counting allocators, the descriptors
+        * are counted by slab capacity, and the instances by the size of their implementation: the singletons
+        * registered on this container and the idle instances of its pools. Inherited registrations are counted by
+        * the ancestor holding them, apart from their entries in the maps of this container.
+        */
+        MemoryUsage MemoryStats() const;
+
+        /**
+        * @brief Resolves a scoped service from the Container.
+        *
+        * This function is responsible for resolving a scoped service from the Container.
+        * It checks if the service has already been registered in the provided scope. If it has,
+        * it returns an empty std::weak_ptr. If the service has not been registered, it looks for
+        * the service type in the scopedServices map. If the service is not found, an exception is
+        * thrown. If the service is found, a new instance is created through the vtable of its descriptor. The new
+        * service is then added to the services map of the provided scope, and a std::weak_ptr to the
+        * service is returned.
+        *
+        * @param scope The scope in which the service is resolved.
+        *
+        * @return std::weak_ptr<TInterface> A weak_ptr to the resolved scoped service.
+        *
+        * @throw std::runtime_error if the service was not registered.
+        */
+        template<typename TInterface>
+        std::weak_ptr<TInterface> ResolveScoped(std::shared_ptr<Scope> &scope, std::string tag = "") {
+            return std::static_pointer_cast<TInterface>(ResolveIn(*scope, TypeIdOf<TInterface>(), tag, true));
+        }
+
+        /**
+        * @brief Resolves a scoped service from the Container, if it is registered.
+        *
+        * Behaves like ResolveScoped, except that a missing service is no error: nothing is thrown and no message is
+        * built.
+        *
+        * @see TryResolveSingleton
+        *
+        * @param scope The scope in which the service is resolved.
+        *
+        * @return std::weak_ptr<TInterface> A weak_ptr to the resolved scoped service, empty when it is not registered
+        * or when the scope already holds it.
+        */
+        template<typename TInterface>
+        std::weak_ptr<TInterface> TryResolveScoped(std::shared_ptr<Scope> &scope, const std::string &tag = "") {
+            return std::static_pointer_cast<TInterface>(ResolveIn(*scope, TypeIdOf<TInterface>(), tag, false));
+        }
+
+        /**
+        * @brief Resolves every singleton registered for an interface.
+        *
+        * The returned vector is built by the first call following a registration for the interface, and holds one
+        * instance per tag in registration order. The calls after it hand out the same vector and never touch the
+        * per-tag maps, which makes it suited for fan-out over plugins or handlers on hot paths.
+        *
+        * @tparam TInterface The interface type of the services.
+        * @return std::shared_ptr<const std::vector<std::shared_ptr<TInterface>>> All the singleton instances, empty
+        * when none is registered. Registrations made afterwards build a new vector, the one returned is left as is.
+        */
+        template<typename TInterface>
+        std::shared_ptr<const std::vector<std::shared_ptr<TInterface>>> ResolveAllSingletons() {
+            using Instances = const std::vector<std::shared_ptr<TInterface>>;
+            static const auto none = std::make_shared<Instances>();
+
+            auto instances = ResolveAll(TypeIdOf<TInterface>(), &CollectSingletons<TInterface>);
+            return instances ? std::static_pointer_cast<Instances>(instances) : none;
+        }
+
+        /**
+        * @brief Resolves every transient service registered for an interface.
+        *
+        * A new instance is created for each registered tag, in registration order. The registrations are walked
+        * contiguously, no tag lookup is performed.
+        *
+        * @tparam TInterface The interface type of the services.
+        * @return std::vector<std::shared_ptr<TInterface>> The new instances, empty when none is registered.
+        */
+        template<typename TInterface>
+        std::vector<std::shared_ptr<TInterface>> ResolveAllTransients() {
+            std::vector<std::shared_ptr<TInterface>> all;
+
+            EpochReclaimer::ReadGuard guard;
+            auto group = transientServices.Find(TypeIdOf<TInterface>());
+            if (!group) {
+                return all;
+            }
+
+            auto entries = group->Published();
+            all.reserve(entries.size());
+            for (auto &entry: entries) {
+                auto service = entry.Service();
+                all.push_back(std::static_pointer_cast<TInterface>(service->vtable->create(*service, nullptr)));
+            }
+
+            return all;
+        }
+
+        /**
+        * @brief Resolves every scoped service registered for an interface.
+        *
+        * The first call for a given scope creates one instance per registered tag and stores them in the scope as a
+        * single contiguous set. Later calls within the same scope hand out that same set.
+        *
+        * @param scope The scope in which the services are resolved.
+        *
+        * @return std::vector<std::weak_ptr<TInterface>> Weak pointers to the scoped instances, in registration order.
+        */
+        template<typename TInterface>
+        std::vector<std::weak_ptr<TInterface>> ResolveAllScoped(std::shared_ptr<Scope> &scope) {
+            using InstanceSet = std::vector<std::shared_ptr<TInterface>>;
+
+            auto &set = scope->serviceSets[TypeIdOf<TInterface>()];
+            if (!set) {
+                auto instances = std::make_shared<InstanceSet>();
+
+                EpochReclaimer::ReadGuard guard;
+                if (auto group = scopedServices.Find(TypeIdOf<TInterface>())) {
+                    auto entries = group->Published();
+                    instances->reserve(entries.size());
+                    for (auto &entry: entries) {
+                        auto service = entry.Service();
+                        instances->push_back(std::static_pointer_cast<TInterface>(
+                                service->vtable->create(*service, scope->resource)));
+                        scope->instanceBytes += service->vtable->instanceSize;
+                        if (service->disposal == Disposal::Inline) {
+                            scope->inlineSets.insert(TypeIdOf<TInterface>());
+                        }
+                    }
+                }
+
+                set = instances;
+            }
+
+            auto &instances = *std::static_pointer_cast<InstanceSet>(set);
+            return {instances.begin(), instances.end()};
+        }
+
+
+    private:
+        /**
+        * @brief Where a registration published in a container comes from.
+        */
+        enum class Origin : unsigned char {
+            Registered,     // a new registration, it must not be registered here yet
+            Replaced,       // a registration overriding the one registered here, or inherited, for the same tag
+            Inherited       // a registration pushed by the parent, shadowed by the local ones
+        };
+
+        /**
+        * @brief A registration on its way to the registries.
+        */
+        struct Publication {
+            ServiceRegistry Container::*registry;
+            TypeId type;
+            std::string tag;
+            ServiceDescriptor *service;
+        };
+
+        // Wraps a singleton instance, typed after its interface, in an erased DecoratorFnc
+        using WrapFnc = std::shared_ptr<void> (*)(ErasedFnc, const std::shared_ptr<void> &,
+                                                  std::pmr::memory_resource *);
+
+        // Builds the replica of a per-node singleton for a node
+        using ReplicaFnc = std::function<std::shared_ptr<void>(std::size_t)>;
+
+        // Builds the pool of a reusable scoped implementation, see MakeInstancePool
+        using PoolFnc = std::shared_ptr<InstancePool> (*)(std::size_t, std::shared_ptr<MemoryAccount>);
+
+        explicit Container(Container *parent);
+
+        /*
+        * The type-erased core. Everything below works on TypeId and descriptors, it is defined in ContainerCore.hpp:
+        * inline by default, compiled once in ContainerCore.cpp with INJECTTOR_STATIC_CORE.
+        */
+
+        /**
+        * @brief Registers an implementation under a type and tag, unless this container already registered it.
+        *
+        * @param duplicate The error message when the type and tag are already registered here.
+        * @param pool Reusable scoped services only, the pool of their instances.
+        */
+        void Register(ServiceRegistry Container::*registry, TypeId type, const std::string &tag,
+                      const ServiceVTable *vtable, Disposal disposal, const char *duplicate,
+                      std::shared_ptr<InstancePool> pool = nullptr);
+
+        /**
+        * @brief Registers a factory under its signature, decorated by the decorators of its interface.
+        */
+        void AddFactory(TypeId signature, TypeId type, const std::string &tag, const ServiceVTable *vtable,
+                        ErasedFnc factory);
+
+        /**
+        * @return std::shared_ptr<void> A singleton instance, a new transient one or the thread-local one of the calling
+        * thread, as a pointer to the interface; nullptr when nothing is registered and the service is not required.
+        * New transient instances are allocated from the resource, when given.
+        * @throw std::runtime_error if a required service is not registered.
+        */
+        std::shared_ptr<void> Resolve(Lifetime lifetime, TypeId type, const std::string &tag, bool required,
+                                      std::pmr::memory_resource *resource = nullptr);
+
+        /**
+        * @return void* The singleton instance, as a pointer to the interface owned by the container; nullptr when
+        * nothing is registered and the service is not required.
+        * @throw std::runtime_error if a required service is not registered.
+        */
+        void *Borrow(TypeId type, const std::string &tag, bool required);
+
+        /**
+        * @return std::shared_ptr<void> The ResolveAllSingletons result for an interface, built by collect when the
+        * registrations changed since the last call; nullptr when none is registered.
+        */
+        std::shared_ptr<void> ResolveAll(TypeId type, CollectFnc collect);
+
+        /**
+        * @return std::shared_ptr<void> A new scoped instance stored in the scope, nullptr when the scope already holds
+        * one, or when nothing is registered and the service is not required.
+        * @throw std::runtime_error if a required service is not registered.
+        */
+        std::shared_ptr<void> ResolveIn(Scope &scope, TypeId type, const std::string &tag, bool required);
+
+        /**
+        * @brief The factory registered for a signature, to be called inside an EpochReclaimer::ReadGuard.
+        *
+        * @throw std::runtime_error naming the interface if there is none.
+        */
+        const ServiceDescriptor &FactoryOf(TypeId signature, TypeId type, const std::string &tag);
+
+        std::shared_ptr<InstancePool> PoolOf(TypeId type, const std::string &tag);
+
+        /**
+        * @brief Adds a decorator to the chain of an interface, and decorates what is already registered for it.
+        */
+        void Decorate(TypeId type, ErasedFnc decorator, WrapFnc wrap);
+
+        /**
+        * @brief Replaces every registration of an interface visible in this container with a decorated one.
+        */
+        void DecorateExisting(ServiceRegistry Container::*registry, TypeId type, ErasedFnc decorator, WrapFnc wrap);
+
+        /**
+        * @param pooled The vtable used instead when the previous registration was reusable, nullptr when the
+        * implementation cannot be.
+        * @return bool Whether something was registered in the registry for the type and tag.
+        */
+        bool ReplaceIn(ServiceRegistry Container::*registry, TypeId type, const std::string &tag,
+                       const ServiceVTable *vtable, const ServiceVTable *pooled, PoolFnc makePool);
+
+        /**
+        * @brief Allocates the descriptor of a registration, constructing the instance right away for singletons.
+        *
+        * The descriptor takes a snapshot of the decorators currently registered for the interface.
+        */
+        ServiceDescriptor *BuildDescriptor(const ServiceVTable *vtable, TypeId type, Disposal disposal);
+
+        /**
+        * @brief Builds the replicas of a per-node singleton, each on a thread running on its node.
+        *
+        * @param replicaOf Builds the replica of a node, from the ReplicaResource.
+        * @param dependencies Receives the singletons the first replica resolved, the others resolve the same ones.
+        */
+        std::shared_ptr<const ReplicaSet> BuildReplicas(std::size_t count, const ReplicaFnc &replicaOf,
+                                                        std::vector<const ServiceDescriptor *> &dependencies);
+
+        /**
+        * @throw std::runtime_error if a new registration was registered meanwhile on another thread, it is then
+        * discarded.
+        */
+        ServiceDescriptor *Publish(ServiceRegistry Container::*registry, TypeId type, const std::string &tag,
+                                   ServiceDescriptor *service, Origin origin);
+
+        /**
+        * @brief Stores registrations in the flattened view of this container and of its children.
+        *
+        * The registrations are grouped by shard, and every shard receiving one is locked for the whole update, in
+        * one order, whatever the number of registrations it receives. Local registrations are recorded as such, so
+        * that they shadow what the parent publishes later on. Inherited registrations stop at the first child that
+        * overrides them. Shards are published one after the other, readers may see some of the registrations before
+        * the others.
+        *
+        * @param rejected Receives every registration, the duplicate first, when a new one is already registered here;
+        * nothing is published then.
+        * @return std::vector<ServiceDescriptor *> For each registration, the local one it displaced, if any.
+        */
+        std::vector<ServiceDescriptor *> Publish(const std::vector<Publication> &publications, Origin origin,
+                                                 std::vector<std::size_t> &rejected);
+
+        /**
+        * @brief Applies the registrations of one shard to its Writer, the shard being locked and checked.
+        */
+        static void Stage(ServiceRegistry::Writer &writer, const std::vector<Publication> &publications,
+                          const std::vector<std::size_t> &indices, Origin origin,
+                          std::vector<ServiceDescriptor *> &displaced, std::vector<bool> &applied);
+
+        /**
+        * @brief Looks up the entry registered for a type and tag, nullptr when there is none.
+        *
+        * To be called inside an EpochReclaimer::ReadGuard. With the thread cache enabled the thread-local table is
+        * probed first, and filled on a miss.
+        */
+        ServiceDescriptor *Find(const ServiceRegistry &registry, Lifetime lifetime, TypeId type,
+                                const std::string &tag);
+
+        static ServiceDescriptor *Lookup(const ServiceRegistry &registry, TypeId type, const std::string &tag);
+
+        /**
+        * @return bool Whether this container registered the type and tag itself, inherited registrations aside.
+        */
+        static bool IsRegistered(const ServiceRegistry &registry, TypeId type, const std::string &tag);
+
+        /**
+        * @return std::string Why a dependency is not satisfied, empty when it is.
+        */
+        std::string Unsatisfied(const std::string &consumer, const Dependency &dependency) const;
+
+        static const char *NameOf(Lifetime lifetime);
+
+        static std::uint64_t NextId();
+
+        static ServiceRegistry Container::*RegistryOf(Lifetime lifetime);
+
+        [[noreturn]] static void NotFound(const char *message, TypeId type);
+
+        void CommitBatch(const std::vector<Batch::Binding> &bindings);
+
+        /**
+        * @brief Releases a registration that was never published, or no longer is.
+        */
+        void Discard(ServiceDescriptor *service);
+
+        /**
+        * @brief Releases a displaced registration once no resolve in flight can still be using it.
+        */
+        void Retire(ServiceDescriptor *service);
+
+        std::shared_ptr<const DecoratorChain> DecoratorsOf(TypeId type) const;
+
+        /**
+        * @brief The singletons a singleton resolved while it was constructed, wherever it was registered.
+        */
+        std::vector<const ServiceDescriptor *> DependenciesOf(const ServiceDescriptor *service) const;
+
+        /**
+        * @brief Records the singletons a singleton registered here resolved while it was constructed.
+        */
+        void SetDependencies(const ServiceDescriptor *service,
+                             const std::vector<const ServiceDescriptor *> &dependencies);
+
+        CountingAllocator<char> Bookkeeping() const {
+            return {memory.get(), MemoryCategory::Bookkeeping};
+        }
+
+        /*
+        * The typed shims. What depends on the interface or the implementation is instantiated per type, and kept
+        * down to the vtables, the casts and the compile-time checks.
+        */
+
+        /**
+        * @brief Whether the dependencies declared by the implementation all outlive the lifetime.
+        */
+        template<typename TImplementation, Lifetime lifetime>
+        static constexpr bool CanHave = !DependencyListOf<TImplementation>::template Captures<lifetime>;
+
+        template<typename TImplementation, Lifetime lifetime>
+        static constexpr void CheckLifetimes() {
+            static_assert((CanHave<TImplementation, lifetime>),
+                          "TImplementation depends on a service with a shorter lifetime than its own: singletons may "
+                          "only depend on singletons, thread-local services on singletons and thread-local services, "
+                          "scoped services on anything but transient services");
+        }
+
+        template<typename TInterface, typename TImplementation, Lifetime lifetime>
+        static constexpr const ServiceVTable *VTableFor() {
+            CheckLifetimes<TImplementation, lifetime>();
+            return &ServiceVTableOf<TInterface, TImplementation, lifetime>;
+        }
+
+        /**
+        * @brief Replaces the registration of one lifetime, only this lifetime is checked against the dependencies.
+        *
+        * @return bool Whether something was registered with the lifetime for the type and tag.
+        */
+        template<class TInterface, class TImplementation, Lifetime lifetime>
+        bool ReplaceAs(const std::string &tag) {
+            // A reusable scoped service stays reusable
+            const ServiceVTable *pooled = nullptr;
+            PoolFnc makePool = nullptr;
+            if constexpr (lifetime == Lifetime::Scoped && requires(TImplementation &instance) { instance.Reset(); }) {
+                pooled = &PooledVTableOf<TInterface, TImplementation>;
+                makePool = &MakeInstancePool<TImplementation>;
+            }
+
+            return ReplaceIn(RegistryOf(lifetime), TypeIdOf<TInterface>(), tag,
+                             VTableFor<TInterface, TImplementation, lifetime>(), pooled, makePool);
+        }
+
+        /**
+        * @brief Releases a wave of independent singletons, timing each of them.
+        *
+        * The singletons must have been unlinked, and the reclaimer synchronized since, so no resolve can reach them.
+        */
+        template<typename TNode>
+        void Release(std::vector<TNode> &nodes, const std::vector<std::size_t> &wave, bool parallel) {
+            auto release = [this, &nodes](std::size_t index) {
+                auto &node = nodes[index];
+                auto start = std::chrono::steady_clock::now();
+                node.report.destroyed = EpochReclaimer::Release(node.service, *slab);
+                node.report.duration = std::chrono::steady_clock::now() - start;
+            };
+
+            std::size_t workers = parallel ? std::min<std::size_t>(wave.size(), std::thread::hardware_concurrency()) : 1;
+            if (workers <= 1) {
+                for (auto index: wave) {
+                    release(index);
+                }
+
+                return;
+            }
+
+            std::atomic<std::size_t> next{0};
+            auto work = [&] {
+                for (auto i = next++; i < wave.size(); i = next++) {
+                    release(wave[i]);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1; i < workers; i++) {
+                threads.emplace_back(work);
+            }
+
+            work();
+            for (auto &thread: threads) {
+                thread.join();
+            }
+        }
+
+        template<typename TInterface, typename TImplementation, typename... Args>
+        static std::shared_ptr<TInterface> Construct(Args &&... args) {
+            ResolutionFrame frame(TypeIdOf<TImplementation>());
+            return std::make_shared<TImplementation>(std::forward<Args>(args)...);
+        }
+
+        /**
+        * @brief Passes rvalues through and copies lvalues, so that factories always receive rvalue references. Text
+        * given as character pointers is copied to a std::string.
+        */
+        template<typename T>
+        static decltype(auto) FactoryArgument(T &value) {
+            if constexpr (std::is_lvalue_reference<T>::value || IsCharacterPointer<T>) {
+                return FactoryParameter<T>(value);
+            } else {
+                return static_cast<std::decay_t<T> &&>(value);
+            }
+        }
+
+        template<typename TInterface>
+        static std::shared_ptr<void> WrapSingleton(ErasedFnc decorator, const std::shared_ptr<void> &instance,
+                                                   std::pmr::memory_resource *resource) {
+            auto wrapped = reinterpret_cast<DecoratorFnc<TInterface>>(decorator);
+            return wrapped(std::static_pointer_cast<TInterface>(instance), resource);
+        }
+
+        template<typename TInterface>
+        static std::shared_ptr<void> CollectSingletons(const ServiceGroup &group) {
+            auto instances = std::make_shared<std::vector<std::shared_ptr<TInterface>>>();
+            auto entries = group.Published();
+            instances->reserve(entries.size());
+
+            for (auto &entry: entries) {
+                if (auto service = entry.Service()) {
+                    instances->push_back(std::static_pointer_cast<TInterface>(service->instance));
+                }
+            }
+
+            return instances;
+        }
+
+        const std::uint64_t id = NextId();
+
+        // Read on every resolve, cached entries are validated on their own, so relaxed loads are enough
+        std::atomic<bool> threadCache{false};
+
+        // Counts what the maps below allocate, which must go first. Shared with the slab and the pools, which may
+        // outlive the container
+        std::shared_ptr<MemoryAccount> memory = std::make_shared<MemoryAccount>();
+
+        Container *parent = nullptr;
+        std::vector<Container *> children;
+
+        // Descriptors registered on this container, and the slabs holding the ones inherited from its ancestors
+        std::shared_ptr<DescriptorSlab> slab = std::make_shared<DescriptorSlab>(memory);
+        std::vector<std::shared_ptr<DescriptorSlab>> inheritedSlabs;
+
+        // Registrations by lifetime, sharded by type; singletonServices also holds the instances inline
+        ServiceRegistry scopedServices{memory.get()};
+        ServiceRegistry singletonServices{memory.get()};
+        ServiceRegistry transientServices{memory.get()};
+        ServiceRegistry factoryServices{memory.get()};
+        ServiceRegistry threadLocalServices{memory.get()};
+
+        // Created up front, scopes may be created on several threads at once; its thread starts on the first post
+        const std::shared_ptr<DisposalQueue> disposalQueue = std::make_shared<DisposalQueue>();
+
+        // Decorator chains by interface type
+        CountedMap<TypeId, std::shared_ptr<const DecoratorChain>> decorators{Bookkeeping()};
+
+        // Replaced registrations waiting for the resolves in flight to complete
+        EpochReclaimer reclaimer;
+
+        // Singletons resolved by each singleton registered here while it was constructed
+        CountedMap<const ServiceDescriptor *, CountedVector<const ServiceDescriptor *>> singletonDependencies{
+                Bookkeeping()};
+
+        // Guard children, decorators and singletonDependencies, registrations may run on several threads at once
+        mutable std::mutex familyLock;
+        mutable std::mutex decoratorLock;
+        mutable std::mutex dependencyLock;
+    };
+
+}
+
+#if !INJECTTOR_STATIC_CORE
+#include "ContainerCore.hpp"
+#endif
 
-#endif //INJECTTORTEST_CONTAINER_HPP
\ No newline at end of file
+#endif //INJECTTORTEST_CONTAINER_HPP
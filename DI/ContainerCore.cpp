@@ -0,0 +1,9 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// The only definition of the non-template core of the Container, for the programs linking InjecttorCore
+
+#if !INJECTTOR_STATIC_CORE
+#error "ContainerCore.cpp must be compiled with INJECTTOR_STATIC_CORE=1, as the InjecttorCore target does"
+#endif
+
+#include "ContainerCore.hpp"
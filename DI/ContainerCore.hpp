@@ -0,0 +1,872 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_CONTAINERCORE_HPP
+#define INJECTTORTEST_CONTAINERCORE_HPP
+
+/*
+* The non-template core of the Container: registration, lookup, publication and error reporting, all keyed by TypeId.
+* The member templates of the Container only add the typed parts around it, so this code exists once per program
+* rather than once per service type.
+*
+* Included by Container.hpp, where it is inline. The InjecttorCore library defines INJECTTOR_STATIC_CORE and compiles
+* it in ContainerCore.cpp instead, which keeps it out of every translation unit including Container.hpp.
+*/
+
+#include "Container.hpp"
+
+#if INJECTTOR_STATIC_CORE
+#define INJECTTOR_CORE
+#else
+#define INJECTTOR_CORE inline
+#endif
+
+namespace DI {
+
+    INJECTTOR_CORE Container::Container(std::pmr::memory_resource *resource)
+            : memory(std::make_shared<MemoryAccount>(resource ? resource : std::pmr::get_default_resource())) {}
+
+    INJECTTOR_CORE Container::Container(Container *parent)
+            : threadCache(parent->threadCache.load(std::memory_order_relaxed)),
+              memory(std::make_shared<MemoryAccount>(parent->memory->Resource())),
+              parent(parent),
+              inheritedSlabs(parent->inheritedSlabs) {
+        // Inherited descriptors live in the slabs of the ancestors, which must outlive them
+        inheritedSlabs.push_back(parent->slab);
+
+        {
+            std::lock_guard<std::mutex> lock(parent->decoratorLock);
+            decorators = parent->decorators;
+        }
+
+        // Known to the parent first, so that what it publishes while its registries are copied is not missed
+        {
+            std::lock_guard<std::mutex> lock(parent->familyLock);
+            parent->children.push_back(this);
+        }
+
+        for (auto registry: {&Container::scopedServices, &Container::singletonServices,
+                             &Container::transientServices, &Container::factoryServices,
+                             &Container::threadLocalServices}) {
+            (this->*registry).Inherit(parent->*registry, reclaimer);
+        }
+    }
+
+    INJECTTOR_CORE Container::~Container() {
+        if (parent) {
+            std::lock_guard<std::mutex> lock(parent->familyLock);
+            auto &siblings = parent->children;
+            siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+        }
+
+        std::lock_guard<std::mutex> lock(familyLock);
+        for (auto child: children) {
+            child->parent = nullptr;
+        }
+    }
+
+    INJECTTOR_CORE std::shared_ptr<Container> Container::CreateChild() {
+        return std::shared_ptr<Container>(new Container(this));
+    }
+
+    INJECTTOR_CORE void Container::Validate() const {
+        std::string problems;
+        std::unordered_set<const Dependency *> checked;
+
+        EpochReclaimer::ReadGuard guard;
+        for (auto registry: {&Container::singletonServices, &Container::scopedServices,
+                             &Container::transientServices, &Container::factoryServices,
+                             &Container::threadLocalServices}) {
+            (this->*registry).ForEach([&](TypeId, const ServiceGroup &group) {
+                for (auto &entry: group.Published()) {
+                    auto service = entry.Service();
+                    if (!service) {
+                        continue;
+                    }
+
+                    auto vtable = service->vtable;
+                    for (std::size_t i = 0; i < vtable->dependencyCount; i++) {
+                        auto &dependency = vtable->dependencies[i];
+                        if (checked.insert(&dependency).second) {
+                            problems += Unsatisfied(group.typeName, dependency);
+                        }
+                    }
+                }
+            });
+        }
+
+        if (!problems.empty()) {
+            RaiseError(Error::InvalidRegistrations, "Invalid registrations:\n" + problems);
+        }
+    }
+
+    INJECTTOR_CORE std::shared_ptr<Container::Scope> Container::CreateScope(Disposal disposal,
+                                                                            std::pmr::memory_resource *resource) {
+        std::shared_ptr<DisposalQueue> queue;
+        if (disposal == Disposal::Deferred) {
+            queue = disposalQueue;
+        }
+
+        if (resource) {
+            return std::allocate_shared<Scope>(std::pmr::polymorphic_allocator<Scope>(resource), std::move(queue),
+                                               resource);
+        }
+
+        return std::make_shared<Scope>(std::move(queue));
+    }
+
+    INJECTTOR_CORE void Container::SetDisposalCapacity(std::size_t capacity) {
+        disposalQueue->SetCapacity(capacity);
+    }
+
+    INJECTTOR_CORE void Container::FlushDisposals() {
+        disposalQueue->Flush();
+    }
+
+    INJECTTOR_CORE MemoryUsage Container::MemoryStats() const {
+        MemoryUsage usage{memory->Bytes(MemoryCategory::Registry), memory->Bytes(MemoryCategory::SingletonTable),
+                          slab->Capacity() * sizeof(ServiceDescriptor), memory->Bytes(MemoryCategory::Bookkeeping), 0};
+
+        EpochReclaimer::ReadGuard guard;
+        singletonServices.ForEach([&usage](TypeId, const ServiceGroup &group) {
+            for (auto &entry: group.Published()) {
+                auto service = entry.Service();
+                if (service && entry.Local()) {
+                    usage.instances += service->vtable->instanceSize *
+                                       (service->replicas ? service->replicas->instances.size() : 1);
+                }
+            }
+        });
+
+        scopedServices.ForEach([&usage](TypeId, const ServiceGroup &group) {
+            for (auto &entry: group.Published()) {
+                auto service = entry.Service();
+                if (service->pool && entry.Local()) {
+                    usage.instances += service->pool->Stats().idle * service->vtable->instanceSize;
+                }
+            }
+        });
+
+        return usage;
+    }
+
+    INJECTTOR_CORE std::vector<ThreadInstances> Container::ThreadLocalInstances() const {
+        return ThreadLocalStore::Snapshot(id);
+    }
+
+    INJECTTOR_CORE std::vector<TeardownReport> Container::Shutdown(bool parallel) {
+        struct Node {
+            ServiceDescriptor *service;
+            TypeId type;
+            TeardownReport report;
+            std::vector<const ServiceDescriptor *> dependencies;
+            std::size_t dependents = 0;
+        };
+
+        std::vector<Node> nodes;
+        std::unordered_map<const ServiceDescriptor *, std::size_t> indices;
+        {
+            EpochReclaimer::ReadGuard guard;
+            singletonServices.ForEach([&nodes, &indices](TypeId type, const ServiceGroup &group) {
+                for (auto &entry: group.Published()) {
+                    auto service = entry.Service();
+                    if (!service || !entry.Local()) {
+                        continue;
+                    }
+
+                    indices.emplace(service, nodes.size());
+                    nodes.push_back({service, type, {group.typeName, std::string(entry.tag),
+                                                     std::chrono::nanoseconds::zero(), false}});
+                }
+            });
+        }
+
+        // Read up front, the descriptors go back to the slab as they are released
+        for (auto &node: nodes) {
+            node.dependencies = DependenciesOf(node.service);
+            for (auto dependency: node.dependencies) {
+                auto it = indices.find(dependency);
+                if (it != indices.end()) {
+                    nodes[it->second].dependents++;
+                }
+            }
+        }
+
+        std::vector<TeardownReport> reports;
+        std::vector<bool> released(nodes.size(), false);
+        while (reports.size() < nodes.size()) {
+            std::vector<std::size_t> wave;
+            for (std::size_t i = 0; i < nodes.size(); i++) {
+                if (!released[i] && nodes[i].dependents == 0) {
+                    wave.push_back(i);
+                }
+            }
+
+            // Only reachable with a dependency cycle, release the rest last registered first
+            if (wave.empty()) {
+                for (std::size_t i = nodes.size(); i-- > 0;) {
+                    if (!released[i]) {
+                        wave.push_back(i);
+                        break;
+                    }
+                }
+            }
+
+            // Unlinked wave by wave: the singletons of later waves stay resolvable, by the destructors of this one
+            for (auto i: wave) {
+                singletonServices.Remove(nodes[i].type, nodes[i].report.tag, reclaimer);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(dependencyLock);
+                for (auto i: wave) {
+                    singletonDependencies.erase(nodes[i].service);
+                }
+            }
+
+            ThreadResolveCache::Epoch().fetch_add(1, std::memory_order_acq_rel);
+            reclaimer.Synchronize();
+            Release(nodes, wave, parallel);
+
+            for (auto i: wave) {
+                released[i] = true;
+                reports.push_back(nodes[i].report);
+
+                for (auto dependency: nodes[i].dependencies) {
+                    auto it = indices.find(dependency);
+                    if (it != indices.end() && nodes[it->second].dependents > 0) {
+                        nodes[it->second].dependents--;
+                    }
+                }
+            }
+        }
+
+        // What is left was inherited
+        singletonServices.Clear(reclaimer);
+        ThreadResolveCache::Epoch().fetch_add(1, std::memory_order_acq_rel);
+        return reports;
+    }
+
+    INJECTTOR_CORE void Container::Register(ServiceRegistry Container::*registry, TypeId type, const std::string &tag,
+                                            const ServiceVTable *vtable, Disposal disposal, const char *duplicate,
+                                            std::shared_ptr<InstancePool> pool) {
+        if (IsRegistered(this->*registry, type, tag)) {
+            RaiseError(Error::AlreadyRegistered, duplicate);
+        }
+
+        auto service = BuildDescriptor(vtable, type, disposal);
+        service->pool = std::move(pool);
+        Publish(registry, type, tag, service, Origin::Registered);
+    }
+
+    INJECTTOR_CORE void Container::AddFactory(TypeId signature, TypeId type, const std::string &tag,
+                                              const ServiceVTable *vtable, ErasedFnc factory) {
+        if (IsRegistered(factoryServices, signature, tag)) {
+            RaiseError(Error::AlreadyRegistered, "Factory already registered with this tag");
+        }
+
+        auto service = BuildDescriptor(vtable, type, Disposal::Deferred);
+        service->factory = factory;
+        Publish(&Container::factoryServices, signature, tag, service, Origin::Registered);
+    }
+
+    INJECTTOR_CORE std::shared_ptr<void> Container::Resolve(Lifetime lifetime, TypeId type, const std::string &tag,
+                                                            bool required, std::pmr::memory_resource *resource) {
+        {
+            EpochReclaimer::ReadGuard guard;
+            if (lifetime == Lifetime::Singleton) {
+                if (auto slot = singletonServices.Singletons(type).Find(type, tag)) {
+                    SingletonConstruction::Record(slot->descriptor);
+                    return slot->replicas ? slot->replicas->Local() : slot->instance;
+                }
+            } else if (lifetime == Lifetime::ThreadLocal) {
+                if (auto service = Find(threadLocalServices, Lifetime::ThreadLocal, type, tag)) {
+                    auto &store = ThreadLocalStore::Local();
+                    if (auto instance = store.Find(service->threadSlot)) {
+                        return *instance;
+                    }
+
+                    auto instance = service->vtable->create(*service, nullptr);
+                    store.Store(service->threadSlot, id, service->vtable->instanceSize, instance);
+                    return instance;
+                }
+            } else if (auto service = Find(transientServices, Lifetime::Transient, type, tag)) {
+                return service->vtable->create(*service, resource);
+            }
+        }
+
+        if (required) {
+            switch (lifetime) {
+                case Lifetime::Singleton:
+                    NotFound("Singleton Service not found: ", type);
+                case Lifetime::ThreadLocal:
+                    NotFound("Thread-local Service not found: ", type);
+                default:
+                    NotFound("Transient Service not found: ", type);
+            }
+        }
+
+        return nullptr;
+    }
+
+    INJECTTOR_CORE void *Container::Borrow(TypeId type, const std::string &tag, bool required) {
+        // Lent instances are only valid until the registration is replaced, which invalidates the cached ones too
+        if (auto lent = BorrowCache::Find(id, type, tag)) {
+            SingletonConstruction::Record(lent->descriptor);
+            return lent->instance;
+        }
+
+        {
+            auto epoch = ThreadResolveCache::Epoch().load(std::memory_order_acquire);
+            EpochReclaimer::ReadGuard guard;
+            if (auto slot = singletonServices.Singletons(type).Find(type, tag)) {
+                SingletonConstruction::Record(slot->descriptor);
+
+                auto node = slot->replicas ? NumaTopology::CurrentNode() : NumaTopology::AnyNode;
+                auto instance = (slot->replicas ? slot->replicas->On(node) : slot->instance).get();
+                BorrowCache::Store(epoch, id, type, tag, node, instance, slot->descriptor);
+                return instance;
+            }
+        }
+
+        if (required) {
+            NotFound("Singleton Service not found: ", type);
+        }
+
+        return nullptr;
+    }
+
+    INJECTTOR_CORE std::shared_ptr<void> Container::ResolveAll(TypeId type, CollectFnc collect) {
+        EpochReclaimer::ReadGuard guard;
+        auto group = singletonServices.Find(type);
+        if (!group) {
+            return nullptr;
+        }
+
+        for (auto &entry: group->Published()) {
+            if (auto service = entry.Service()) {
+                SingletonConstruction::Record(service);
+            }
+        }
+
+        // Retired once the registrations change, the vector outlives it through this copy
+        return group->Instances(collect, reclaimer);
+    }
+
+    INJECTTOR_CORE std::shared_ptr<void> Container::ResolveIn(Scope &scope, TypeId type, const std::string &tag,
+                                                              bool required) {
+        // If the scope already has the service, we don't create a new one
+        if (scope.services.count(type)) {
+            return nullptr;
+        }
+
+        EpochReclaimer::ReadGuard guard;
+        auto service = Find(scopedServices, Lifetime::Scoped, type, tag);
+        if (!service) {
+            if (required) {
+                NotFound("Service was not found: ", type);
+            }
+
+            return nullptr;
+        }
+
+        auto instance = service->vtable->create(*service, scope.resource);
+        scope.services[type] = instance;
+        scope.instanceBytes += service->vtable->instanceSize;
+        if (service->disposal == Disposal::Inline) {
+            scope.inlineServices.insert(type);
+        }
+
+        return instance;
+    }
+
+    INJECTTOR_CORE const ServiceDescriptor &Container::FactoryOf(TypeId signature, TypeId type,
+                                                                 const std::string &tag) {
+        auto service = Find(factoryServices, Lifetime::Transient, signature, tag);
+        if (!service) {
+            NotFound("Factory not found: ", type);
+        }
+
+        return *service;
+    }
+
+    INJECTTOR_CORE std::shared_ptr<InstancePool> Container::PoolOf(TypeId type, const std::string &tag) {
+        EpochReclaimer::ReadGuard guard;
+        auto service = Find(scopedServices, Lifetime::Scoped, type, tag);
+        if (!service || !service->pool) {
+            NotFound("Reusable scoped service not found: ", type);
+        }
+
+        // Shared, the descriptor is recycled once the registration is replaced
+        return service->pool;
+    }
+
+    INJECTTOR_CORE void Container::Decorate(TypeId type, ErasedFnc decorator, WrapFnc wrap) {
+        {
+            // Chains are shared with the children and with the registered descriptors, they are never modified in place
+            std::lock_guard<std::mutex> lock(decoratorLock);
+            auto &entry = decorators[type];
+            auto chain = entry ? std::allocate_shared<DecoratorChain>(Bookkeeping(), *entry, Bookkeeping())
+                               : std::allocate_shared<DecoratorChain>(Bookkeeping(), Bookkeeping());
+            chain->push_back(decorator);
+            entry = chain;
+        }
+
+        DecorateExisting(&Container::singletonServices, type, decorator, wrap);
+        DecorateExisting(&Container::transientServices, type, decorator, wrap);
+        DecorateExisting(&Container::scopedServices, type, decorator, wrap);
+        DecorateExisting(&Container::threadLocalServices, type, decorator, wrap);
+    }
+
+    INJECTTOR_CORE void Container::DecorateExisting(ServiceRegistry Container::*registry, TypeId type,
+                                                    ErasedFnc decorator, WrapFnc wrap) {
+        std::vector<std::pair<std::string, ServiceDescriptor *>> registrations;
+        {
+            EpochReclaimer::ReadGuard guard;
+            auto group = (this->*registry).Find(type);
+            if (!group) {
+                return;
+            }
+
+            for (auto &entry: group->Published()) {
+                registrations.emplace_back(std::string(entry.tag), entry.Service());
+            }
+        }
+
+        for (auto &[tag, inner]: registrations) {
+            auto chain = inner->decorators
+                         ? std::allocate_shared<DecoratorChain>(Bookkeeping(), *inner->decorators, Bookkeeping())
+                         : std::allocate_shared<DecoratorChain>(Bookkeeping(), Bookkeeping());
+            chain->push_back(decorator);
+
+            auto decorated = slab->Allocate();
+            decorated->vtable = inner->vtable;
+            decorated->decorators = std::move(chain);
+            decorated->disposal = inner->disposal;
+            decorated->pool = inner->pool;
+            if (inner->vtable->lifetime == Lifetime::ThreadLocal) {
+                // Threads construct the decorated instances afresh, the ones they hold stay undecorated
+                decorated->threadSlot = ThreadSlot::Acquire();
+            }
+
+            if (registry == &Container::singletonServices) {
+                // The existing instance is wrapped once, the decorated singleton takes over its dependencies
+                SingletonConstruction construction;
+                if (inner->replicas) {
+                    auto &replicas = inner->replicas->instances;
+                    decorated->replicas = BuildReplicas(replicas.size(), [&](std::size_t node) {
+                        return wrap(decorator, replicas[node], &ReplicaResource::Instance());
+                    }, construction.dependencies);
+                    decorated->instance = decorated->replicas->instances.front();
+                } else {
+                    decorated->instance = wrap(decorator, inner->instance, nullptr);
+                }
+
+                auto dependencies = DependenciesOf(inner);
+                dependencies.insert(dependencies.end(), construction.dependencies.begin(),
+                                    construction.dependencies.end());
+                SetDependencies(decorated, dependencies);
+            }
+
+            // Only the decorator holds a local instance from now on, the parent may still expose an inherited one.
+            // Publishing it as replaced makes it local, so later replacements in the parent skip it
+            Retire(Publish(registry, type, tag, decorated, Origin::Replaced));
+        }
+    }
+
+    INJECTTOR_CORE bool Container::ReplaceIn(ServiceRegistry Container::*registry, TypeId type, const std::string &tag,
+                                             const ServiceVTable *vtable, const ServiceVTable *pooled,
+                                             PoolFnc makePool) {
+        Disposal disposal;
+        std::shared_ptr<InstancePool> pool;
+        {
+            EpochReclaimer::ReadGuard guard;
+            auto previous = Lookup(this->*registry, type, tag);
+            if (!previous) {
+                return false;
+            }
+
+            disposal = previous->disposal;
+            pool = previous->pool;
+        }
+
+        // A reusable scoped service stays reusable
+        bool reusable = pool && pooled;
+        auto service = BuildDescriptor(reusable ? pooled : vtable, type, disposal);
+        if (reusable) {
+            service->pool = makePool(pool->Stats().capacity, memory);
+        }
+
+        // Inherited registrations still belong to the parent, only a local one is displaced
+        Retire(Publish(registry, type, tag, service, Origin::Replaced));
+        return true;
+    }
+
+    INJECTTOR_CORE ServiceDescriptor *Container::BuildDescriptor(const ServiceVTable *vtable, TypeId type,
+                                                                 Disposal disposal) {
+        auto descriptor = slab->Allocate();
+        descriptor->vtable = vtable;
+        descriptor->decorators = DecoratorsOf(type);
+        descriptor->disposal = disposal;
+        if (vtable->lifetime == Lifetime::ThreadLocal) {
+            descriptor->threadSlot = ThreadSlot::Acquire();
+        }
+
+        if (vtable->lifetime == Lifetime::Singleton) {
+            SingletonConstruction construction;
+            if (vtable->perNode) {
+                descriptor->replicas = BuildReplicas(NumaTopology::NodeCount(), [vtable, descriptor](std::size_t) {
+                    return vtable->create(*descriptor, &ReplicaResource::Instance());
+                }, construction.dependencies);
+                descriptor->instance = descriptor->replicas->instances.front();
+            } else {
+                descriptor->instance = vtable->create(*descriptor, nullptr);
+            }
+
+            SetDependencies(descriptor, construction.dependencies);
+        }
+
+        return descriptor;
+    }
+
+    INJECTTOR_CORE std::shared_ptr<const ReplicaSet> Container::BuildReplicas(
+            std::size_t count, const ReplicaFnc &replicaOf, std::vector<const ServiceDescriptor *> &dependencies) {
+        auto replicas = std::allocate_shared<ReplicaSet>(Bookkeeping(), Bookkeeping());
+        replicas->instances.resize(count);
+        for (std::size_t node = 0; node < count; node++) {
+            // One node at a time, so that constructors never run concurrently with each other
+            NumaTopology::RunOn(node, [&] {
+                SingletonConstruction construction;
+                replicas->instances[node] = replicaOf(node);
+                if (node == 0) {
+                    dependencies.insert(dependencies.end(), construction.dependencies.begin(),
+                                        construction.dependencies.end());
+                }
+            });
+        }
+
+        return replicas;
+    }
+
+    INJECTTOR_CORE ServiceDescriptor *Container::Publish(ServiceRegistry Container::*registry, TypeId type,
+                                                         const std::string &tag, ServiceDescriptor *service,
+                                                         Origin origin) {
+        // Registered concurrently by another thread since it was checked
+        std::vector<std::size_t> rejected;
+        auto displaced = Publish({{registry, type, tag, service}}, origin, rejected).front();
+        if (!rejected.empty()) {
+            Discard(service);
+            RaiseError(Error::AlreadyRegistered, "Service already registered: " + std::string(type->name()));
+        }
+
+        return displaced;
+    }
+
+    INJECTTOR_CORE std::vector<ServiceDescriptor *> Container::Publish(const std::vector<Publication> &publications,
+                                                                       Origin origin,
+                                                                       std::vector<std::size_t> &rejected) {
+        std::vector<ServiceDescriptor *> displaced(publications.size(), nullptr);
+        std::vector<bool> applied(publications.size(), false);
+        {
+            // Every shard receiving a registration is locked, in the order every transaction follows
+            ServiceRegistry::Transaction transaction(reclaimer);
+            std::vector<std::pair<ServiceRegistry::Writer *, std::vector<std::size_t>>> shards;
+            for (auto registry: {&Container::scopedServices, &Container::singletonServices,
+                                 &Container::transientServices, &Container::factoryServices,
+                                 &Container::threadLocalServices}) {
+                std::array<std::vector<std::size_t>, ServiceRegistry::ShardCount> indices;
+                for (std::size_t i = 0; i < publications.size(); i++) {
+                    if (publications[i].registry == registry) {
+                        indices[ServiceRegistry::ShardOf(publications[i].type)].push_back(i);
+                    }
+                }
+
+                for (std::size_t shard = 0; shard < indices.size(); shard++) {
+                    if (!indices[shard].empty()) {
+                        shards.emplace_back(&transaction.Open(this->*registry, shard), std::move(indices[shard]));
+                    }
+                }
+            }
+
+            // Checked before anything is staged, so that a duplicate leaves every shard as it was
+            if (origin == Origin::Registered) {
+                for (auto &[writer, indices]: shards) {
+                    for (auto i: indices) {
+                        auto current = writer->Find(publications[i].type);
+                        auto entry = current ? current->Staged(publications[i].tag) : nullptr;
+                        if (entry && entry->Local()) {
+                            // The duplicate first, for the error message
+                            rejected.push_back(i);
+                            for (std::size_t index = 0; index < publications.size(); index++) {
+                                if (index != i) {
+                                    rejected.push_back(index);
+                                }
+                            }
+
+                            return displaced;
+                        }
+                    }
+                }
+            }
+
+            for (auto &[writer, indices]: shards) {
+                Stage(*writer, publications, indices, origin, displaced, applied);
+            }
+
+            transaction.Commit();
+        }
+
+        // Cached lookups made before the update are stale from now on
+        ThreadResolveCache::Epoch().fetch_add(1, std::memory_order_acq_rel);
+
+        std::vector<Publication> inherited;
+        for (std::size_t i = 0; i < publications.size(); i++) {
+            if (applied[i]) {
+                inherited.push_back(publications[i]);
+            }
+        }
+
+        if (!inherited.empty()) {
+            std::vector<Container *> heirs;
+            {
+                std::lock_guard<std::mutex> lock(familyLock);
+                heirs = children;
+            }
+
+            std::vector<std::size_t> none;
+            for (auto child: heirs) {
+                child->Publish(inherited, Origin::Inherited, none);
+            }
+        }
+
+        return displaced;
+    }
+
+    INJECTTOR_CORE void Container::Stage(ServiceRegistry::Writer &writer, const std::vector<Publication> &publications,
+                                         const std::vector<std::size_t> &indices, Origin origin,
+                                         std::vector<ServiceDescriptor *> &displaced, std::vector<bool> &applied) {
+        bool singletons = publications[indices.front()].registry == &Container::singletonServices;
+        if (singletons) {
+            writer.Retire(writer.Singletons().Reserve(indices.size()));
+        }
+
+        for (auto i: indices) {
+            auto &publication = publications[i];
+            auto &group = writer.Group(publication.type, publication.type->name());
+            auto current = group.Staged(publication.tag);
+            if (current && current->Local()) {
+                if (origin == Origin::Inherited) {
+                    continue;
+                }
+
+                displaced[i] = current->Service();
+            }
+
+            group.Set(publication.tag, publication.service, origin != Origin::Inherited);
+            if (singletons) {
+                writer.Retire(writer.Singletons().Set(publication.type, publication.tag, publication.service));
+            }
+
+            applied[i] = true;
+        }
+    }
+
+    INJECTTOR_CORE ServiceDescriptor *Container::Find(const ServiceRegistry &registry, Lifetime lifetime, TypeId type,
+                                                      const std::string &tag) {
+        std::uint64_t epoch = 0;
+        bool cached = threadCache.load(std::memory_order_relaxed);
+        if (cached) {
+            if (auto service = ThreadResolveCache::Find(id, lifetime, type, tag)) {
+                return service;
+            }
+
+            epoch = ThreadResolveCache::Epoch().load(std::memory_order_acquire);
+        }
+
+        auto service = Lookup(registry, type, tag);
+        if (service && cached) {
+            ThreadResolveCache::Store(epoch, id, lifetime, type, tag, service);
+        }
+
+        return service;
+    }
+
+    INJECTTOR_CORE ServiceDescriptor *Container::Lookup(const ServiceRegistry &registry, TypeId type,
+                                                        const std::string &tag) {
+        auto group = registry.Find(type);
+        if (!group) {
+            return nullptr;
+        }
+
+        auto entry = group->Find(tag);
+        return entry ? entry->Service() : nullptr;
+    }
+
+    INJECTTOR_CORE bool Container::IsRegistered(const ServiceRegistry &registry, TypeId type, const std::string &tag) {
+        EpochReclaimer::ReadGuard guard;
+        auto group = registry.Find(type);
+        auto entry = group ? group->Find(tag) : nullptr;
+        return entry && entry->Local();
+    }
+
+    INJECTTOR_CORE std::string Container::Unsatisfied(const std::string &consumer, const Dependency &dependency) const {
+        auto type = dependency.type();
+        if ((this->*RegistryOf(dependency.lifetime)).Find(type)) {
+            return {};
+        }
+
+        std::string problem = consumer + " depends on " + type->name() + " as a " + NameOf(dependency.lifetime) +
+                              " service, ";
+        for (auto lifetime: {Lifetime::Singleton, Lifetime::ThreadLocal, Lifetime::Scoped, Lifetime::Transient}) {
+            if ((this->*RegistryOf(lifetime)).Find(type)) {
+                return problem + "but it is registered as a " + NameOf(lifetime) + " service\n";
+            }
+        }
+
+        return problem + "which is not registered\n";
+    }
+
+    INJECTTOR_CORE const char *Container::NameOf(Lifetime lifetime) {
+        switch (lifetime) {
+            case Lifetime::Singleton:
+                return "singleton";
+            case Lifetime::ThreadLocal:
+                return "thread-local";
+            case Lifetime::Scoped:
+                return "scoped";
+            default:
+                return "transient";
+        }
+    }
+
+    INJECTTOR_CORE std::uint64_t Container::NextId() {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    INJECTTOR_CORE ServiceRegistry Container::*Container::RegistryOf(Lifetime lifetime) {
+        switch (lifetime) {
+            case Lifetime::Singleton:
+                return &Container::singletonServices;
+            case Lifetime::ThreadLocal:
+                return &Container::threadLocalServices;
+            case Lifetime::Scoped:
+                return &Container::scopedServices;
+            default:
+                return &Container::transientServices;
+        }
+    }
+
+    INJECTTOR_CORE void Container::NotFound(const char *message, TypeId type) {
+        RaiseError(Error::NotFound, message + std::string(type->name()));
+    }
+
+    INJECTTOR_CORE void Container::CommitBatch(const std::vector<Batch::Binding> &bindings) {
+        // Everything is validated before the first change; keyed by TypeId, distinct types may share a name
+        std::set<std::tuple<Lifetime, TypeId, std::string>> keys;
+        for (auto &binding: bindings) {
+            bool registered = IsRegistered(this->*RegistryOf(binding.lifetime), binding.type, binding.tag);
+            if (registered || !keys.emplace(binding.lifetime, binding.type, binding.tag).second) {
+                RaiseError(Error::AlreadyRegistered, "Service already registered: " + std::string(binding.type->name()));
+            }
+        }
+
+        slab->Reserve(bindings.size());
+        std::vector<ServiceDescriptor *> services;
+        services.reserve(bindings.size());
+#if INJECTTOR_EXCEPTIONS
+        try {
+            for (auto &binding: bindings) {
+                services.push_back(BuildDescriptor(binding.vtable, binding.type, binding.disposal));
+            }
+        } catch (...) {
+            // The singletons constructed so far are never published, release them right away
+            for (auto service: services) {
+                Discard(service);
+            }
+
+            throw;
+        }
+#else
+        for (auto &binding: bindings) {
+            services.push_back(BuildDescriptor(binding.vtable, binding.type, binding.disposal));
+        }
+#endif
+
+        // Each shard is updated once for the whole batch, its singleton table sized once
+        std::vector<Publication> publications;
+        publications.reserve(bindings.size());
+        for (std::size_t i = 0; i < bindings.size(); i++) {
+            auto &binding = bindings[i];
+            publications.push_back({RegistryOf(binding.lifetime), binding.type, binding.tag, services[i]});
+        }
+
+        // A registration made meanwhile on another thread leaves the whole batch out
+        std::vector<std::size_t> rejected;
+        Publish(publications, Origin::Registered, rejected);
+        if (!rejected.empty()) {
+            for (auto i: rejected) {
+                Discard(services[i]);
+            }
+
+            auto typeName = bindings[rejected.front()].type->name();
+            RaiseError(Error::AlreadyRegistered, "Service already registered: " + std::string(typeName));
+        }
+    }
+
+    INJECTTOR_CORE void Container::Retire(ServiceDescriptor *service) {
+        if (!service) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(dependencyLock);
+            singletonDependencies.erase(service);
+        }
+
+        reclaimer.Retire(service, *slab);
+    }
+
+    INJECTTOR_CORE void Container::Discard(ServiceDescriptor *service) {
+        {
+            std::lock_guard<std::mutex> lock(dependencyLock);
+            singletonDependencies.erase(service);
+        }
+
+        service->vtable->destroy(*service);
+        slab->Free(service);
+    }
+
+    INJECTTOR_CORE std::shared_ptr<const DecoratorChain> Container::DecoratorsOf(TypeId type) const {
+        std::lock_guard<std::mutex> lock(decoratorLock);
+        auto entry = decorators.find(type);
+        return entry == decorators.end() ? nullptr : entry->second;
+    }
+
+    INJECTTOR_CORE std::vector<const ServiceDescriptor *> Container::DependenciesOf(const ServiceDescriptor *service) const {
+        for (auto container = this; container; container = container->parent) {
+            std::lock_guard<std::mutex> lock(container->dependencyLock);
+            auto it = container->singletonDependencies.find(service);
+            if (it != container->singletonDependencies.end()) {
+                return {it->second.begin(), it->second.end()};
+            }
+        }
+
+        return {};
+    }
+
+    INJECTTOR_CORE void Container::SetDependencies(const ServiceDescriptor *service,
+                                                   const std::vector<const ServiceDescriptor *> &dependencies) {
+        if (dependencies.empty()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(dependencyLock);
+        CountedVector<const ServiceDescriptor *> recorded(dependencies.begin(), dependencies.end(), Bookkeeping());
+        singletonDependencies.insert_or_assign(service, std::move(recorded));
+    }
+
+}
+
+#undef INJECTTOR_CORE
+
+#endif //INJECTTORTEST_CONTAINERCORE_HPP
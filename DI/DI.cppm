@@ -0,0 +1,44 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// The DI named module, experimental: translation units importing it instead of including Container.hpp are meant to
+// parse neither the container nor the standard headers it depends on, the compiled module interface is loaded instead.
+// It is not part of the tested builds, see the README.
+//
+// import DI;
+//
+// DI::Container::Instance().RegisterSingleton<ILogger, Logger>();
+
+module;
+
+#include "Container.hpp"
+
+export module DI;
+
+export namespace DI {
+
+    // Containers and scopes
+    using DI::Container;
+    using DI::Lifetime;
+    using DI::Disposal;
+    using DI::TeardownReport;
+    using DI::PoolStats;
+    using DI::InstancePool;
+    using DI::MemoryUsage;
+    using DI::NumaTopology;
+    using DI::ThreadInstances;
+
+    // Declared dependencies
+    using DI::DependsOn;
+    using DI::Singleton;
+    using DI::Scoped;
+    using DI::Transient;
+    using DI::ThreadLocal;
+
+    // Type identity and errors
+    using DI::TypeId;
+    using DI::TypeIdOf;
+    using DI::Error;
+    using DI::ErrorHandler;
+    using DI::SetErrorHandler;
+
+}
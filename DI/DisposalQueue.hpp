@@ -0,0 +1,151 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_DISPOSALQUEUE_HPP
+#define INJECTTORTEST_DISPOSALQUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DI {
+
+    /**
+    * @brief How the services of a scope are disposed of when the scope ends.
+    */
+    enum class Disposal : unsigned char {
+        Inline,     // destroyed on the thread that ends the scope
+        Deferred    // handed over to a background thread
+    };
+
+    /**
+    * @class DisposalQueue
+    *
+    * @brief The DisposalQueue class destroys service instances on a background thread.
+    *
+    * Scopes created with Disposal::Deferred post their instances to the queue when they end, so that expensive
+    * destructors, closing database contexts for instance, do not add latency to the thread that ended the scope.
+    * The queue is bounded: once the given number of instances is pending, posts are refused and the caller destroys
+    * the instances itself. The worker thread is started on the first post and drains the queue before it stops.
+    */
+    class DisposalQueue {
+    public:
+        static constexpr std::size_t DefaultCapacity = 4096;
+
+        explicit DisposalQueue(std::size_t capacity = DefaultCapacity) : capacity(capacity) {}
+
+        /**
+        * @brief Drains the queue and stops the worker thread.
+        */
+        ~DisposalQueue() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+
+            wake.notify_all();
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        DisposalQueue(const DisposalQueue &) = delete;
+
+        DisposalQueue &operator=(const DisposalQueue &) = delete;
+
+        /**
+        * @brief Hands instances over to the worker thread.
+        *
+        * @param instances The instances to destroy, emptied when the post is accepted.
+        * @return bool false when the queue is full, the instances are then left to the caller.
+        */
+        bool Post(std::vector<std::shared_ptr<void>> &instances) {
+            if (instances.empty()) {
+                return true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (pending + instances.size() > capacity) {
+                    return false;
+                }
+
+                pending += instances.size();
+                for (auto &instance: instances) {
+                    queue.push_back(std::move(instance));
+                }
+
+                if (!worker.joinable()) {
+                    worker = std::thread(&DisposalQueue::Run, this);
+                }
+            }
+
+            instances.clear();
+            wake.notify_one();
+            return true;
+        }
+
+        /**
+        * @brief Blocks until every posted instance has been destroyed, typically at shutdown.
+        */
+        void Flush() {
+            std::unique_lock<std::mutex> lock(mutex);
+            drained.wait(lock, [this] { return pending == 0; });
+        }
+
+        /**
+        * @brief Sets the maximum number of instances waiting to be destroyed.
+        */
+        void SetCapacity(std::size_t value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            capacity = value;
+        }
+
+        /**
+        * @return std::size_t The number of instances waiting to be destroyed.
+        */
+        std::size_t Pending() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pending;
+        }
+
+    private:
+        void Run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+
+                std::vector<std::shared_ptr<void>> batch;
+                batch.swap(queue);
+
+                // The destructors run without holding the lock, posts are not blocked meanwhile
+                lock.unlock();
+                auto count = batch.size();
+                batch.clear();
+                lock.lock();
+
+                pending -= count;
+                if (pending == 0) {
+                    drained.notify_all();
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable drained;
+        std::vector<std::shared_ptr<void>> queue;
+        std::size_t pending = 0;
+        std::size_t capacity;
+        bool stopping = false;
+        std::thread worker;
+    };
+
+}
+
+#endif //INJECTTORTEST_DISPOSALQUEUE_HPP
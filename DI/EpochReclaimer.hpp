@@ -0,0 +1,241 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_EPOCHRECLAIMER_HPP
+#define INJECTTORTEST_EPOCHRECLAIMER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ServiceDescriptor.hpp"
+
+namespace DI {
+
+    /**
+    * @class EpochReclaimer
+    *
+    * @brief The EpochReclaimer class defers the release of replaced registrations until no resolve can still use them.
+    *
+    * Resolves run inside a ReadGuard, which announces the global epoch the thread entered in. Objects unlinked by a
+    * writer are retired with the epoch current at that moment, and released once every thread still inside a guard
+    * entered after it: those threads can only have seen what replaced them. Readers never block, entering and leaving
+    * a guard costs a store to the record of the thread and a fence. Each record has a cache line of its own, so
+    * threads entering guards never write to a line another thread writes to.
+    */
+    class EpochReclaimer {
+        struct Reader;
+
+    public:
+        /**
+        * @class ReadGuard
+        *
+        * @brief Protects what the current thread reads from the container maps until the guard is destroyed.
+        *
+        * Guards nest, only the outermost one announces the thread.
+        */
+        class ReadGuard final {
+        public:
+            ReadGuard() : reader(Reader::Local()) {
+                if (reader.depth++ == 0) {
+                    reader.epoch.store(Epoch().load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            ~ReadGuard() {
+                if (--reader.depth == 0) {
+                    reader.epoch.store(Idle, std::memory_order_release);
+                }
+            }
+
+            ReadGuard(const ReadGuard &) = delete;
+
+            ReadGuard &operator=(const ReadGuard &) = delete;
+
+        private:
+            Reader &reader;
+        };
+
+        EpochReclaimer() = default;
+
+        EpochReclaimer(const EpochReclaimer &) = delete;
+
+        EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+        /**
+        * @brief Keeps an object alive until no reader can reach it anymore.
+        *
+        * The object must already be unlinked from everything readers start from.
+        */
+        void Retire(std::shared_ptr<void> object) {
+            if (object) {
+                Add({0, std::move(object), nullptr, nullptr});
+            }
+        }
+
+        /**
+        * @brief Destroys what a descriptor owns, its singleton instance included, once no reader can reach it anymore,
+        * and hands the descriptor back to its slab.
+        */
+        void Retire(ServiceDescriptor *descriptor, DescriptorSlab &slab) {
+            Add({0, nullptr, descriptor, &slab});
+        }
+
+        /**
+        * @brief Releases every retired object no reader can reach anymore.
+        *
+        * @return std::size_t The number of objects still waiting for readers to move on.
+        */
+        std::size_t Collect() {
+            std::vector<Retired> ready;
+            std::size_t pending;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto oldest = OldestReader();
+
+                auto reachable = std::partition(retired.begin(), retired.end(),
+                                                [oldest](const Retired &entry) { return entry.epoch >= oldest; });
+                ready.assign(std::make_move_iterator(reachable), std::make_move_iterator(retired.end()));
+                retired.erase(reachable, retired.end());
+                pending = retired.size();
+            }
+
+            // Destructors run outside the lock, they may well resolve or retire in turn
+            for (auto &entry: ready) {
+                if (entry.descriptor) {
+                    Release(entry.descriptor, *entry.slab);
+                }
+            }
+
+            return pending;
+        }
+
+        /**
+        * @brief Waits until no reader can reach what was unlinked before the call anymore, then releases what was
+        * retired by then.
+        *
+        * Readers entering meanwhile are not waited for, they can only see what replaced it. Neither is the guard of the
+        * calling thread, if any: what it protects is released once it leaves it.
+        */
+        void Synchronize() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto epoch = Epoch().fetch_add(1, std::memory_order_seq_cst);
+            auto &self = Reader::Local();
+            while (OldestReader(&self) <= epoch) {
+                std::this_thread::yield();
+            }
+
+            Collect();
+        }
+
+        /**
+        * @brief Destroys what a descriptor owns on the calling thread, and hands the descriptor back to its slab.
+        *
+        * What Retire does once no reader can reach the descriptor anymore, for descriptors unlinked before a
+        * Synchronize.
+        *
+        * @return bool Whether that destroyed the singleton instance.
+        */
+        static bool Release(ServiceDescriptor *descriptor, DescriptorSlab &slab) {
+            auto destroyed = descriptor->vtable->destroy(*descriptor);
+            slab.Free(descriptor);
+            return destroyed;
+        }
+
+    private:
+        static constexpr std::uint64_t Idle = 0;
+
+        struct Retired {
+            std::uint64_t epoch;
+            std::shared_ptr<void> object;
+            ServiceDescriptor *descriptor;
+            DescriptorSlab *slab;
+        };
+
+        static constexpr std::size_t CacheLine = 64;
+
+        /**
+        * @brief The announcement of one thread, records are recycled when their thread exits and never freed.
+        */
+        struct alignas(CacheLine) Reader {
+            std::atomic<std::uint64_t> epoch{Idle};
+            std::atomic<bool> used{true};
+            unsigned depth = 0;
+            Reader *next = nullptr;
+
+            static Reader &Local() {
+                thread_local Lease lease;
+                return *lease.reader;
+            }
+
+            static std::atomic<Reader *> &Head() {
+                static std::atomic<Reader *> head{nullptr};
+                return head;
+            }
+
+            struct Lease {
+                Lease() {
+                    for (reader = Head().load(std::memory_order_acquire); reader; reader = reader->next) {
+                        bool expected = false;
+                        if (reader->used.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                            return;
+                        }
+                    }
+
+                    reader = new Reader();
+                    reader->next = Head().load(std::memory_order_relaxed);
+                    while (!Head().compare_exchange_weak(reader->next, reader, std::memory_order_acq_rel)) {
+                    }
+                }
+
+                ~Lease() {
+                    reader->used.store(false, std::memory_order_release);
+                }
+
+                Reader *reader;
+            };
+        };
+
+        static std::atomic<std::uint64_t> &Epoch() {
+            static std::atomic<std::uint64_t> epoch{Idle + 1};
+            return epoch;
+        }
+
+        static std::uint64_t OldestReader(const Reader *except = nullptr) {
+            auto oldest = std::numeric_limits<std::uint64_t>::max();
+            for (auto reader = Reader::Head().load(std::memory_order_acquire); reader; reader = reader->next) {
+                auto epoch = reader->epoch.load(std::memory_order_acquire);
+                if (epoch != Idle && reader != except) {
+                    oldest = std::min(oldest, epoch);
+                }
+            }
+
+            return oldest;
+        }
+
+        void Add(Retired entry) {
+            // Orders the unlinking before the epoch readers compare against
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            entry.epoch = Epoch().fetch_add(1, std::memory_order_seq_cst);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                retired.push_back(std::move(entry));
+            }
+
+            Collect();
+        }
+
+        std::mutex mutex;
+        std::vector<Retired> retired;
+    };
+
+}
+
+#endif //INJECTTORTEST_EPOCHRECLAIMER_HPP
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_ERRORS_HPP
+#define INJECTTORTEST_ERRORS_HPP
+
+// Errors are thrown as std::runtime_error when exceptions are enabled, builds with -fno-exceptions abort by default
+#ifndef INJECTTOR_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define INJECTTOR_EXCEPTIONS 1
+#else
+#define INJECTTOR_EXCEPTIONS 0
+#endif
+#endif
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#if INJECTTOR_EXCEPTIONS
+#include <stdexcept>
+#endif
+
+namespace DI {
+
+    /**
+    * @brief What went wrong, as reported to the ErrorHandler.
+    */
+    enum class Error : unsigned char {
+        AlreadyRegistered,      // a service is registered twice with the same tag
+        NotFound,               // a service to resolve, create or replace is not registered
+        DependencyCycle,        // a service depends on itself, directly or not
+        InvalidRegistrations    // Container::Validate found dependencies not registered as declared
+    };
+
+    /**
+    * @brief Receives the errors of the containers; it must not return, it throws or terminates instead.
+    */
+    using ErrorHandler = void (*)(Error error, const std::string &message);
+
+    /**
+    * @brief Throws a std::runtime_error carrying the message, or prints it and aborts without exceptions.
+    */
+    inline void DefaultErrorHandler(Error, const std::string &message) {
+#if INJECTTOR_EXCEPTIONS
+        throw std::runtime_error(message);
+#else
+        std::fputs(message.c_str(), stderr);
+        std::fputc('\n', stderr);
+        std::abort();
+#endif
+    }
+
+    inline std::atomic<ErrorHandler> &CurrentErrorHandler() {
+        static std::atomic<ErrorHandler> handler{&DefaultErrorHandler};
+        return handler;
+    }
+
+    /**
+    * @brief Installs the handler receiving the errors of every container, for instance to log them before
+    * terminating in builds without exceptions.
+    *
+    * @return ErrorHandler The handler previously installed.
+    */
+    inline ErrorHandler SetErrorHandler(ErrorHandler handler) {
+        return CurrentErrorHandler().exchange(handler ? handler : &DefaultErrorHandler);
+    }
+
+    /**
+    * @brief Reports an error to the installed handler, and aborts if the handler returns.
+    */
+    [[noreturn]] inline void RaiseError(Error error, const std::string &message) {
+        CurrentErrorHandler().load(std::memory_order_acquire)(error, message);
+        std::abort();
+    }
+
+}
+
+#endif //INJECTTORTEST_ERRORS_HPP
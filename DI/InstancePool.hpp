@@ -0,0 +1,211 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_INSTANCEPOOL_HPP
+#define INJECTTORTEST_INSTANCEPOOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Errors.hpp"
+#include "MemoryAccount.hpp"
+
+namespace DI {
+
+    /**
+    * @struct PoolStats
+    *
+    * @brief The PoolStats struct is a snapshot of the activity of an InstancePool.
+    */
+    struct PoolStats {
+        std::size_t idle;           // instances reset and waiting for a scope
+        std::size_t inUse;          // instances currently held by scopes
+        std::size_t highWaterMark;  // most instances in use at once since the last trim
+        std::size_t constructed;    // instances constructed, because none was idle
+        std::size_t reused;         // instances handed out again instead of being constructed
+        std::size_t capacity;       // maximum number of idle instances kept
+    };
+
+    /**
+    * @class InstancePool
+    *
+    * @brief The InstancePool class recycles the instances of a reusable scoped service across scopes.
+    *
+    * When a scope releases an instance it is reset and kept for the next scope, up to the capacity of the pool;
+    * beyond that it is destroyed. Instances are stored untyped, the pool goes through the construct, reset and
+    * destroy functions of the implementation. Instances may be released from any thread, the disposal thread
+    * included, so every operation is guarded by a mutex. The list of idle instances is charged to the account of
+    * the container, as bookkeeping; the pool keeps the account alive, since scopes may outlive the container.
+    */
+    class InstancePool {
+    public:
+        static constexpr std::size_t DefaultCapacity = 64;
+
+        using ConstructFnc = void *(*)();
+        using ResetFnc = void (*)(void *);
+        using DestroyFnc = void (*)(void *);
+
+        InstancePool(ConstructFnc construct, ResetFnc reset, DestroyFnc destroy, std::size_t capacity,
+                     std::shared_ptr<MemoryAccount> account = nullptr)
+                : construct(construct), reset(reset), destroy(destroy), account(std::move(account)),
+                  idle(CountingAllocator<void *>(this->account.get(), MemoryCategory::Bookkeeping)),
+                  capacity(capacity) {}
+
+        ~InstancePool() {
+            for (auto instance: idle) {
+                destroy(instance);
+            }
+        }
+
+        InstancePool(const InstancePool &) = delete;
+
+        InstancePool &operator=(const InstancePool &) = delete;
+
+        /**
+        * @brief Hands out an idle instance, or constructs a new one when none is left.
+        */
+        void *Acquire() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle.empty()) {
+                    auto instance = idle.back();
+                    idle.pop_back();
+                    reused++;
+                    Lend();
+                    return instance;
+                }
+            }
+
+            // Constructors may resolve other services, they never run under the lock
+            auto instance = construct();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            constructed++;
+            Lend();
+            return instance;
+        }
+
+        /**
+        * @brief Takes an instance back, resets it and keeps it for the next scope, or destroys it when the pool is
+        * full or the reset throws.
+        */
+        void Release(void *instance) noexcept {
+            bool keep = false;
+#if INJECTTOR_EXCEPTIONS
+            try {
+                reset(instance);
+                keep = true;
+            } catch (...) {
+            }
+#else
+            reset(instance);
+            keep = true;
+#endif
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inUse--;
+                if (keep && idle.size() < capacity) {
+                    idle.push_back(instance);
+                    return;
+                }
+            }
+
+            destroy(instance);
+        }
+
+        /**
+        * @brief Constructs instances ahead of time, so that the first scopes do not pay for them.
+        *
+        * @param count The number of idle instances wanted, bounded by the capacity.
+        */
+        void Reserve(std::size_t count) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (idle.size() < std::min(count, capacity)) {
+                lock.unlock();
+                auto instance = construct();
+                lock.lock();
+
+                constructed++;
+                idle.push_back(instance);
+            }
+        }
+
+        /**
+        * @brief Sets the maximum number of idle instances, destroying the ones beyond it.
+        */
+        void SetCapacity(std::size_t value) {
+            std::vector<void *> surplus;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                capacity = value;
+                Take(capacity, surplus);
+            }
+
+            for (auto instance: surplus) {
+                destroy(instance);
+            }
+        }
+
+        /**
+        * @brief Destroys the idle instances beyond the given number and starts a new high-water mark window.
+        *
+        * A typical policy trims the pool down to the last high-water mark minus what is in use, periodically, so
+        * that it follows the load.
+        *
+        * @return std::size_t The number of instances destroyed.
+        */
+        std::size_t Trim(std::size_t keep = 0) {
+            std::vector<void *> surplus;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                Take(keep, surplus);
+                highWaterMark = inUse;
+            }
+
+            for (auto instance: surplus) {
+                destroy(instance);
+            }
+
+            return surplus.size();
+        }
+
+        PoolStats Stats() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return {idle.size(), inUse, highWaterMark, constructed, reused, capacity};
+        }
+
+    private:
+        void Lend() {
+            inUse++;
+            highWaterMark = std::max(highWaterMark, inUse);
+        }
+
+        void Take(std::size_t keep, std::vector<void *> &surplus) {
+            while (idle.size() > keep) {
+                surplus.push_back(idle.back());
+                idle.pop_back();
+            }
+        }
+
+        ConstructFnc construct;
+        ResetFnc reset;
+        DestroyFnc destroy;
+
+        std::mutex mutex;
+
+        // Counts the list of idle instances, which must go after it
+        std::shared_ptr<MemoryAccount> account;
+        CountedVector<void *> idle;
+        std::size_t inUse = 0;
+        std::size_t highWaterMark = 0;
+        std::size_t constructed = 0;
+        std::size_t reused = 0;
+        std::size_t capacity;
+    };
+
+}
+
+#endif //INJECTTORTEST_INSTANCEPOOL_HPP
@@ -0,0 +1,162 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_MEMORYACCOUNT_HPP
+#define INJECTTORTEST_MEMORYACCOUNT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace DI {
+
+    /**
+    * @brief What the memory counted by a MemoryAccount is used for.
+    */
+    enum class MemoryCategory : unsigned char {
+        Registry,           // the sharded maps of the groups, the groups, their entries, indexes and tags
+        SingletonTable,     // the slots of the flat singleton tables and their tags
+        Bookkeeping,        // decorator chains, per-node replica sets, idle instance lists, singleton dependencies
+        Count
+    };
+
+    /**
+    * @struct MemoryUsage
+    *
+    * @brief The MemoryUsage struct is a snapshot of the memory held by a container or by a scope, in bytes.
+    *
+    * Registry, singletonTable and bookkeeping are counted by the allocators of the maps as they allocate and
+    * deallocate, tags longer than the small string buffer included.
+    */
+    struct MemoryUsage {
+        std::size_t registry;           // for a scope, the maps indexing its instances
+        std::size_t singletonTable;
+        std::size_t descriptors;        // the descriptor slab, used or not
+        std::size_t bookkeeping;
+        std::size_t instances;          // the implementation objects held: singletons, or the instances of a scope
+
+        /**
+        * @return std::size_t What the container itself costs, the service payloads aside.
+        */
+        std::size_t Overhead() const {
+            return registry + singletonTable + descriptors + bookkeeping;
+        }
+
+        std::size_t Total() const {
+            return Overhead() + instances;
+        }
+    };
+
+    /**
+    * @class MemoryAccount
+    *
+    * @brief The MemoryAccount class counts the bytes currently allocated through the CountingAllocators bound to it.
+    *
+    * Those allocators allocate from the memory resource of the account, which must outlive everything they allocated.
+    * Every allocator bound to an account must be gone before the account is destroyed. Counters are updated with
+    * relaxed atomics, allocations happen on registration paths only.
+    */
+    class MemoryAccount {
+    public:
+        explicit MemoryAccount(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : resource(resource) {}
+
+        MemoryAccount(const MemoryAccount &) = delete;
+
+        MemoryAccount &operator=(const MemoryAccount &) = delete;
+
+        void Add(MemoryCategory category, std::size_t bytes) {
+            counters[static_cast<std::size_t>(category)].fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        void Remove(MemoryCategory category, std::size_t bytes) {
+            counters[static_cast<std::size_t>(category)].fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        std::size_t Bytes(MemoryCategory category) const {
+            return counters[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+        }
+
+        std::pmr::memory_resource *Resource() const {
+            return resource;
+        }
+
+    private:
+        std::pmr::memory_resource *resource;
+        std::array<std::atomic<std::size_t>, static_cast<std::size_t>(MemoryCategory::Count)> counters{};
+    };
+
+    /**
+    * @class CountingAllocator
+    *
+    * @brief The CountingAllocator class allocates from the memory resource of an account, and charges it what it
+    * allocates.
+    *
+    * Without an account it allocates like std::allocator and counts nothing. Containers copied from one another keep
+    * the account of their source, containers assigned to keep their own.
+    */
+    template<class T>
+    class CountingAllocator {
+    public:
+        using value_type = T;
+
+        CountingAllocator(MemoryAccount *account, MemoryCategory category) noexcept
+                : account(account), category(category) {}
+
+        template<class U>
+        CountingAllocator(const CountingAllocator<U> &other) noexcept
+                : account(other.account), category(other.category) {}
+
+        T *allocate(std::size_t count) {
+            if (!account) {
+                return std::allocator<T>().allocate(count);
+            }
+
+            auto pointer = static_cast<T *>(account->Resource()->allocate(count * sizeof(T), alignof(T)));
+            account->Add(category, count * sizeof(T));
+            return pointer;
+        }
+
+        void deallocate(T *pointer, std::size_t count) noexcept {
+            if (!account) {
+                return std::allocator<T>().deallocate(pointer, count);
+            }
+
+            account->Resource()->deallocate(pointer, count * sizeof(T), alignof(T));
+            account->Remove(category, count * sizeof(T));
+        }
+
+        template<class U>
+        bool operator==(const CountingAllocator<U> &other) const noexcept {
+            return account == other.account && category == other.category;
+        }
+
+    private:
+        template<class U>
+        friend class CountingAllocator;
+
+        MemoryAccount *account;
+        MemoryCategory category;
+    };
+
+    template<class TKey, class TValue>
+    using CountedMap = std::unordered_map<TKey, TValue, std::hash<TKey>, std::equal_to<TKey>,
+                                          CountingAllocator<std::pair<const TKey, TValue>>>;
+
+    template<class T>
+    using CountedSet = std::unordered_set<T, std::hash<T>, std::equal_to<T>, CountingAllocator<T>>;
+
+    template<class T>
+    using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+    using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+}
+
+#endif //INJECTTORTEST_MEMORYACCOUNT_HPP
@@ -0,0 +1,257 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_NUMATOPOLOGY_HPP
+#define INJECTTORTEST_NUMATOPOLOGY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Errors.hpp"
+#include "MemoryAccount.hpp"
+
+#if INJECTTOR_EXCEPTIONS
+#include <exception>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace DI {
+
+    /**
+    * @class NumaTopology
+    *
+    * @brief The NumaTopology class maps the CPUs of the machine to their NUMA node.
+    *
+    * On Linux the topology is read once from /sys/devices/system/node, elsewhere every CPU belongs to node 0. The node
+    * of the calling thread is that of the CPU it currently runs on, a vDSO call away. Tests, and single-node machines,
+    * can simulate another topology and assign threads to nodes.
+    */
+    class NumaTopology {
+    public:
+        static constexpr std::size_t AnyNode = static_cast<std::size_t>(-1);
+
+        static std::size_t NodeCount() {
+            return Layout().nodeCount;
+        }
+
+        /**
+        * @return std::size_t The node the calling thread was assigned to, or else the node of the CPU it runs on.
+        */
+        static std::size_t CurrentNode() {
+            if (threadNode != AnyNode) {
+                return threadNode;
+            }
+
+#if defined(__linux__)
+            auto cpu = sched_getcpu();
+            auto &layout = Layout();
+            if (cpu >= 0 && static_cast<std::size_t>(cpu) < layout.nodeOfCpu.size()) {
+                return layout.nodeOfCpu[cpu];
+            }
+#endif
+            return 0;
+        }
+
+        /**
+        * @brief Replaces the detected topology, to be called before anything is registered per node, and never while
+        * resolving.
+        *
+        * @param nodeOfCpu The node of each CPU, indexed by CPU number.
+        */
+        static void Simulate(std::vector<std::size_t> nodeOfCpu) {
+            Layout() = Map(std::move(nodeOfCpu));
+        }
+
+        /**
+        * @brief Makes the calling thread report the given node wherever it runs, AnyNode to go back to its CPU.
+        */
+        static void AssignThread(std::size_t node) {
+            threadNode = node;
+        }
+
+        /**
+        * @brief Runs the work on a thread of its own, bound to the CPUs of the node and assigned to it, and waits for
+        * it. What the work allocates and touches first is therefore local to the node, and resolves it makes see
+        * the node. With a single node the work runs on the calling thread.
+        *
+        * Binding is best effort: on a simulated topology whose CPUs the machine does not have, the thread is only
+        * assigned to the node.
+        */
+        template<typename TWork>
+        static void RunOn(std::size_t node, TWork &&work) {
+            if (NodeCount() == 1) {
+                work();
+                return;
+            }
+
+#if INJECTTOR_EXCEPTIONS
+            std::exception_ptr error;
+            std::thread([&] {
+                Bind(node);
+                AssignThread(node);
+                try {
+                    work();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }).join();
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+#else
+            std::thread([&] {
+                Bind(node);
+                AssignThread(node);
+                work();
+            }).join();
+#endif
+        }
+
+    private:
+        struct Map {
+            explicit Map(std::vector<std::size_t> cpus)
+                    : nodeOfCpu(std::move(cpus)),
+                      nodeCount(nodeOfCpu.empty() ? 1 : *std::max_element(nodeOfCpu.begin(), nodeOfCpu.end()) + 1) {}
+
+            std::vector<std::size_t> nodeOfCpu;
+            std::size_t nodeCount;
+        };
+
+        static void Bind(std::size_t node) {
+#if defined(__linux__)
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            auto &layout = Layout();
+            for (std::size_t cpu = 0; cpu < layout.nodeOfCpu.size() && cpu < CPU_SETSIZE; cpu++) {
+                if (layout.nodeOfCpu[cpu] == node) {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+
+            // Fails when the machine has none of the CPUs, the thread then runs anywhere
+            static_cast<void>(sched_setaffinity(0, sizeof(cpus), &cpus));
+#else
+            static_cast<void>(node);
+#endif
+        }
+
+        static Map &Layout() {
+            static Map layout = Detect();
+            return layout;
+        }
+
+        static Map Detect() {
+            std::vector<std::size_t> nodeOfCpu;
+#if defined(__linux__)
+            for (auto node: ReadList("/sys/devices/system/node/online")) {
+                for (auto cpu: ReadList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+                    if (cpu >= nodeOfCpu.size()) {
+                        nodeOfCpu.resize(cpu + 1, 0);
+                    }
+
+                    nodeOfCpu[cpu] = node;
+                }
+            }
+#endif
+            return Map(std::move(nodeOfCpu));
+        }
+
+        /**
+        * @return std::vector<std::size_t> The numbers of a sysfs list such as "0-3,8-11", empty when it is missing.
+        */
+        static std::vector<std::size_t> ReadList(const std::string &path) {
+            std::vector<std::size_t> numbers;
+            std::ifstream file(path);
+            std::string range;
+            while (std::getline(file, range, ',')) {
+                char *end = nullptr;
+                auto first = std::strtoul(range.c_str(), &end, 10);
+                auto last = *end == '-' ? std::strtoul(end + 1, nullptr, 10) : first;
+                for (auto number = first; number <= last; number++) {
+                    numbers.push_back(number);
+                }
+            }
+
+            return numbers;
+        }
+
+        static inline thread_local std::size_t threadNode = AnyNode;
+    };
+
+    /**
+    * @class ReplicaResource
+    *
+    * @brief The ReplicaResource class allocates the replicas of per-node singletons on cache lines of their own.
+    *
+    * Every block starts on a cache line and is padded to a whole number of them, so an instance allocated along with
+    * its control block never shares a line with anything else.
+    */
+    class ReplicaResource final : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t CacheLine = 64;
+
+        static ReplicaResource &Instance() {
+            // Never destroyed, replicas of static containers may be released after it
+            static auto resource = new ReplicaResource();
+            return *resource;
+        }
+
+    private:
+        static std::size_t Padded(std::size_t bytes) {
+            return (bytes + CacheLine - 1) / CacheLine * CacheLine;
+        }
+
+        static std::align_val_t Aligned(std::size_t alignment) {
+            return std::align_val_t(std::max(alignment, CacheLine));
+        }
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            return ::operator new(Padded(bytes), Aligned(alignment));
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override {
+            ::operator delete(pointer, Padded(bytes), Aligned(alignment));
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    /**
+    * @struct ReplicaSet
+    *
+    * @brief The ReplicaSet struct holds the replicas of a per-node singleton, one per NUMA node.
+    *
+    * Each replica, decorators included, is constructed on a thread running on its node, see NumaTopology::RunOn, and
+    * allocated from the ReplicaResource along with its control block. Its memory is therefore local to its node, and
+    * resolving it, reference counting included, writes to no cache line of another replica. What a replica allocates
+    * afterwards, or shares with the others, is up to its implementation.
+    */
+    struct ReplicaSet {
+        explicit ReplicaSet(const CountingAllocator<char> &allocator) : instances(allocator) {}
+
+        CountedVector<std::shared_ptr<void>> instances;
+
+        const std::shared_ptr<void> &Local() const {
+            return On(NumaTopology::CurrentNode());
+        }
+
+        const std::shared_ptr<void> &On(std::size_t node) const {
+            return instances[node % instances.size()];
+        }
+    };
+
+}
+
+#endif //INJECTTORTEST_NUMATOPOLOGY_HPP
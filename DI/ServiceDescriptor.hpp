@@ -0,0 +1,489 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_SERVICEDESCRIPTOR_HPP
+#define INJECTTORTEST_SERVICEDESCRIPTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "DisposalQueue.hpp"
+#include "Errors.hpp"
+#include "InstancePool.hpp"
+#include "MemoryAccount.hpp"
+#include "NumaTopology.hpp"
+#include "ThreadLocalStore.hpp"
+#include "TypeId.hpp"
+
+namespace DI {
+
+    /**
+    * @brief The lifetime a service has been registered with.
+    */
+    enum class Lifetime : unsigned char {
+        Singleton,
+        Transient,
+        Scoped,
+        ThreadLocal
+    };
+
+    /**
+    * @return int How long instances of the lifetime live, compared to the others: the greater, the longer.
+    */
+    constexpr int LifetimeRank(Lifetime lifetime) {
+        switch (lifetime) {
+            case Lifetime::Singleton:
+                return 3;
+            case Lifetime::ThreadLocal:
+                return 2;
+            case Lifetime::Scoped:
+                return 1;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+    * @brief A dependency declared by an implementation: the interface it resolves and the lifetime it expects.
+    */
+    struct Dependency {
+        TypeId (*type)();
+        Lifetime lifetime;
+    };
+
+    template<class TInterface>
+    struct Singleton {
+        using Interface = TInterface;
+        static constexpr Lifetime lifetime = Lifetime::Singleton;
+    };
+
+    template<class TInterface>
+    struct Scoped {
+        using Interface = TInterface;
+        static constexpr Lifetime lifetime = Lifetime::Scoped;
+    };
+
+    template<class TInterface>
+    struct Transient {
+        using Interface = TInterface;
+        static constexpr Lifetime lifetime = Lifetime::Transient;
+    };
+
+    template<class TInterface>
+    struct ThreadLocal {
+        using Interface = TInterface;
+        static constexpr Lifetime lifetime = Lifetime::ThreadLocal;
+    };
+
+    /**
+    * @brief The services an implementation resolves in its constructor, declared as its Dependencies member type.
+    *
+    * class UserService : public IUserService {
+    * public:
+    *     using Dependencies = DI::DependsOn<DI::Singleton<ILogger>, DI::Scoped<IUnitOfWork>>;
+    * };
+    *
+    * A dependency must live at least as long as the services depending on it, otherwise they would capture it
+    * past its lifetime: singletons depend on singletons only, thread-local services on singletons and thread-local
+    * services, scoped services on anything but transient services. Registering an implementation that breaks this
+    * rule does not compile.
+    */
+    template<class... TDependencies>
+    struct DependsOn {
+        static constexpr std::array<Dependency, sizeof...(TDependencies)> Items{
+                {{&TypeIdOf<typename TDependencies::Interface>, TDependencies::lifetime}...}};
+
+        template<Lifetime consumer>
+        static constexpr bool Captures = ((LifetimeRank(TDependencies::lifetime) < LifetimeRank(consumer)) || ...);
+    };
+
+    template<class TImplementation>
+    struct DeclaredDependencies {
+        using Type = DependsOn<>;
+    };
+
+    template<class TImplementation> requires requires { typename TImplementation::Dependencies; }
+    struct DeclaredDependencies<TImplementation> {
+        using Type = typename TImplementation::Dependencies;
+    };
+
+    template<class TImplementation>
+    using DependencyListOf = typename DeclaredDependencies<TImplementation>::Type;
+
+    /**
+    * @brief Function pointer type used to store typed function pointers in untyped storage.
+    *
+    * Converting a function pointer to another function pointer type and back yields the original pointer.
+    */
+    using ErasedFnc = void (*)();
+
+    /**
+    * @brief Wraps an instance in a decorator, allocated from the resource when one is given.
+    */
+    template<class T>
+    using DecoratorFnc = std::shared_ptr<T> (*)(std::shared_ptr<T>, std::pmr::memory_resource *);
+
+    /**
+    * @brief Whether a runtime argument is text passed as a character pointer, a string literal for instance.
+    */
+    template<class T>
+    constexpr bool IsCharacterPointer = std::is_same_v<std::decay_t<T>, const char *> ||
+                                        std::is_same_v<std::decay_t<T>, char *>;
+
+    /**
+    * @brief The type a runtime argument is handed to a factory as: decayed, and std::string for character pointers.
+    */
+    template<class T>
+    using FactoryParameter = std::conditional_t<IsCharacterPointer<T>, std::string, std::decay_t<T>>;
+
+    /**
+    * @brief Signature identifying the factories of an interface taking the given runtime arguments.
+    */
+    template<class TInterface, class... Args>
+    using FactorySignature = std::shared_ptr<TInterface>(Args...);
+
+    /**
+    * @brief Decorators of an interface, erased DecoratorFnc, applied first to last.
+    */
+    using DecoratorChain = CountedVector<ErasedFnc>;
+
+    struct ServiceDescriptor;
+
+    /**
+    * @struct ServiceVTable
+    *
+    * @brief The ServiceVTable struct is the hand-written virtual table of a registration.
+    *
+    * There is one constant table per interface, implementation and lifetime, shared by every descriptor of that
+    * registration. Descriptors therefore need no virtual functions nor any typed subclass.
+    */
+    struct ServiceVTable {
+        // Builds an instance, returned as a pointer to the interface: nullptr for factories. The instance and its
+        // decorators are allocated from the resource when one is given, pooled instances aside
+        std::shared_ptr<void> (*create)(const ServiceDescriptor &, std::pmr::memory_resource *);
+
+        // Releases what the descriptor owns, returns true when that destroyed the singleton instance
+        bool (*destroy)(ServiceDescriptor &);
+
+        Lifetime lifetime;
+
+        // What the implementation declared it resolves when constructed, see DependsOn
+        const Dependency *dependencies;
+        std::size_t dependencyCount;
+
+        // sizeof the implementation, for the memory statistics
+        std::size_t instanceSize;
+
+        // Singletons only: one replica is built per NUMA node, see ReplicaSet
+        bool perNode;
+    };
+
+    /**
+    * @struct ServiceDescriptor
+    *
+    * @brief The ServiceDescriptor struct describes one registration, whatever its interface and lifetime.
+    *
+    * Descriptors all have the same size and layout, so that they can be stored next to each other in a
+    * DescriptorSlab. Type-specific behaviour goes through the vtable.
+    */
+    struct ServiceDescriptor {
+        const ServiceVTable *vtable = nullptr;
+
+        // Singletons only, a pointer to the interface
+        std::shared_ptr<void> instance;
+
+        // Per-node singletons only, every replica; the first one is the instance
+        std::shared_ptr<const ReplicaSet> replicas;
+
+        // Decorators applied to the created instances, if any
+        std::shared_ptr<const DecoratorChain> decorators;
+
+        // Factories only, the erased function building the instance from the runtime arguments
+        ErasedFnc factory = nullptr;
+
+        // Scoped services only: Disposal::Inline opts the service out of deferred disposal
+        Disposal disposal = Disposal::Deferred;
+
+        // Reusable scoped services only, the instances released by ended scopes
+        std::shared_ptr<InstancePool> pool;
+
+        // Thread-local services only, the slot of their instances in every ThreadLocalStore
+        ThreadSlot threadSlot;
+    };
+
+    /**
+    * @class ResolutionFrame
+    *
+    * @brief The ResolutionFrame class marks an implementation under construction on the current thread.
+    *
+    * Frames live on the stack of the functions constructing services and are chained through a thread-local pointer,
+    * so detecting a cycle costs no allocation, only a walk over the constructions in progress. Nothing is recorded
+    * when no construction runs: resolving a singleton, or anything else that does not construct, pays nothing.
+    */
+    class ResolutionFrame {
+    public:
+        /**
+        * @throw std::runtime_error naming the cycle if the implementation is already under construction.
+        */
+        explicit ResolutionFrame(TypeId type) : type(type), previous(current) {
+            for (auto frame = previous; frame; frame = frame->previous) {
+                if (frame->type == type) {
+                    RaiseError(Error::DependencyCycle, "Dependency cycle detected: " + Describe(frame));
+                }
+            }
+
+            current = this;
+        }
+
+        ~ResolutionFrame() {
+            current = previous;
+        }
+
+        ResolutionFrame(const ResolutionFrame &) = delete;
+
+        ResolutionFrame &operator=(const ResolutionFrame &) = delete;
+
+    private:
+        /**
+        * @return std::string The constructions from the first one of the cycle up to this one, in order.
+        */
+        std::string Describe(const ResolutionFrame *first) const {
+            std::string cycle = type->name();
+            for (auto frame = previous; frame != first->previous; frame = frame->previous) {
+                cycle = std::string(frame->type->name()) + " -> " + cycle;
+            }
+
+            return cycle;
+        }
+
+        static inline thread_local ResolutionFrame *current = nullptr;
+        TypeId type;
+        ResolutionFrame *previous;
+    };
+
+    template<class TInterface>
+    std::shared_ptr<TInterface> ApplyDecorators(std::shared_ptr<TInterface> service, const DecoratorChain *chain,
+                                                std::pmr::memory_resource *resource = nullptr) {
+        if (chain) {
+            for (auto decorator: *chain) {
+                service = reinterpret_cast<DecoratorFnc<TInterface>>(decorator)(std::move(service), resource);
+            }
+        }
+
+        return service;
+    }
+
+    template<class TInterface, class TImplementation>
+    std::shared_ptr<void> CreateInstance(const ServiceDescriptor &descriptor, std::pmr::memory_resource *resource) {
+        ResolutionFrame frame(TypeIdOf<TImplementation>());
+        std::shared_ptr<TInterface> service;
+        if (resource) {
+            service = std::allocate_shared<TImplementation>(std::pmr::polymorphic_allocator<TImplementation>(resource));
+        } else {
+            service = std::make_shared<TImplementation>();
+        }
+
+        return ApplyDecorators<TInterface>(std::move(service), descriptor.decorators.get(), resource);
+    }
+
+    /**
+    * @brief Hands out an instance of the pool of the descriptor, which goes back to the pool once released.
+    *
+    * The pool may be gone by the time the instance is released, along with its container, the instance is then
+    * simply destroyed.
+    */
+    template<class TInterface, class TImplementation>
+    std::shared_ptr<void> AcquireInstance(const ServiceDescriptor &descriptor, std::pmr::memory_resource *) {
+        ResolutionFrame frame(TypeIdOf<TImplementation>());
+        auto instance = static_cast<TImplementation *>(descriptor.pool->Acquire());
+        std::shared_ptr<TInterface> service(std::shared_ptr<TImplementation>(
+                instance, [pool = std::weak_ptr<InstancePool>(descriptor.pool)](TImplementation *instance) {
+                    if (auto owner = pool.lock()) {
+                        owner->Release(instance);
+                    } else {
+                        delete instance;
+                    }
+                }));
+
+        return ApplyDecorators<TInterface>(std::move(service), descriptor.decorators.get());
+    }
+
+    template<class TImplementation>
+    std::shared_ptr<InstancePool> MakeInstancePool(std::size_t capacity, std::shared_ptr<MemoryAccount> account) {
+        return std::make_shared<InstancePool>(
+                []() -> void * { return new TImplementation(); },
+                [](void *instance) { static_cast<TImplementation *>(instance)->Reset(); },
+                [](void *instance) { delete static_cast<TImplementation *>(instance); },
+                capacity, std::move(account));
+    }
+
+    template<class TInterface, class TDecorator>
+    std::shared_ptr<TInterface> DecorateInstance(std::shared_ptr<TInterface> inner,
+                                                 std::pmr::memory_resource *resource) {
+        if (resource) {
+            return std::allocate_shared<TDecorator>(std::pmr::polymorphic_allocator<TDecorator>(resource),
+                                                    std::move(inner));
+        }
+
+        return std::make_shared<TDecorator>(std::move(inner));
+    }
+
+    inline bool DestroyDescriptor(ServiceDescriptor &descriptor) {
+        descriptor.replicas.reset();
+        bool last = descriptor.instance.use_count() == 1;
+        descriptor.instance.reset();
+        descriptor.decorators.reset();
+        return last;
+    }
+
+    template<class TInterface, class TImplementation, Lifetime lifetime>
+    inline constexpr ServiceVTable ServiceVTableOf{&CreateInstance<TInterface, TImplementation>, &DestroyDescriptor,
+                                                   lifetime, DependencyListOf<TImplementation>::Items.data(),
+                                                   DependencyListOf<TImplementation>::Items.size(),
+                                                   sizeof(TImplementation), false};
+
+    template<class TInterface, class TImplementation>
+    inline constexpr ServiceVTable PerNodeVTableOf{&CreateInstance<TInterface, TImplementation>, &DestroyDescriptor,
+                                                   Lifetime::Singleton, DependencyListOf<TImplementation>::Items.data(),
+                                                   DependencyListOf<TImplementation>::Items.size(),
+                                                   sizeof(TImplementation), true};
+
+    template<class TInterface, class TImplementation>
+    inline constexpr ServiceVTable PooledVTableOf{&AcquireInstance<TInterface, TImplementation>, &DestroyDescriptor,
+                                                  Lifetime::Scoped, DependencyListOf<TImplementation>::Items.data(),
+                                                  DependencyListOf<TImplementation>::Items.size(),
+                                                  sizeof(TImplementation), false};
+
+    template<class TImplementation>
+    inline constexpr ServiceVTable FactoryVTableOf{nullptr, &DestroyDescriptor, Lifetime::Transient,
+                                                   DependencyListOf<TImplementation>::Items.data(),
+                                                   DependencyListOf<TImplementation>::Items.size(),
+                                                   sizeof(TImplementation), false};
+
+    /**
+    * @class DescriptorSlab
+    *
+    * @brief The DescriptorSlab class stores the descriptors of a container in a few contiguous chunks.
+    *
+    * Descriptors never move once allocated, so the lookup tables can point at them. Each chunk is twice as large as
+    * the previous one, a registry of n services costs O(log n) allocations, or a single one when its size is
+    * reserved up front. Chunks come from the memory resource of an account, which must outlive the slab. The slab
+    * keeps the account alive: what its descriptors own, decorator chains and replica sets, is charged to it, and
+    * the slabs of a container outlive it as long as a child inherits their descriptors. Descriptors released by
+    * Free, once replaced registrations are reclaimed, are handed out again before the chunks grow, so replacing a
+    * registration over and over reuses the same few descriptors. Registrations may run on several threads at once,
+    * allocations are guarded by a mutex.
+    */
+    class DescriptorSlab {
+    public:
+        explicit DescriptorSlab(std::shared_ptr<MemoryAccount> account)
+                : account(std::move(account)), allocator(this->account->Resource()) {}
+
+        ~DescriptorSlab() {
+            for (auto &chunk: chunks) {
+                std::destroy_n(chunk.items, chunk.capacity);
+                allocator.deallocate(chunk.items, chunk.capacity);
+            }
+        }
+
+        DescriptorSlab(const DescriptorSlab &) = delete;
+
+        DescriptorSlab &operator=(const DescriptorSlab &) = delete;
+
+        ServiceDescriptor *Allocate() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!released.empty()) {
+                auto descriptor = released.back();
+                released.pop_back();
+                count++;
+                return descriptor;
+            }
+
+            if (chunks.empty() || used == chunks.back().capacity) {
+                Grow(chunks.empty() ? FirstChunk : chunks.back().capacity * 2);
+            }
+
+            count++;
+            return &chunks.back().items[used++];
+        }
+
+        /**
+        * @brief Resets a descriptor of the slab and makes it available to Allocate again.
+        *
+        * Nothing may point at the descriptor anymore, see EpochReclaimer.
+        */
+        void Free(ServiceDescriptor *descriptor) {
+            // What the descriptor still owns is released outside the lock, destructors may well register services
+            *descriptor = ServiceDescriptor();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            released.push_back(descriptor);
+            count--;
+        }
+
+        /**
+        * @brief Makes sure the next descriptors are allocated from a single chunk.
+        */
+        void Reserve(std::size_t descriptors) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (chunks.empty() || chunks.back().capacity - used < descriptors) {
+                Grow(std::max(descriptors, chunks.empty() ? FirstChunk : chunks.back().capacity * 2));
+            }
+        }
+
+        /**
+        * @return std::size_t The number of descriptors allocated and not freed.
+        */
+        std::size_t Size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return count;
+        }
+
+        /**
+        * @return std::size_t The number of descriptors the chunks can hold, used or not.
+        */
+        std::size_t Capacity() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::size_t capacity = 0;
+            for (auto &chunk: chunks) {
+                capacity += chunk.capacity;
+            }
+
+            return capacity;
+        }
+
+    private:
+        static constexpr std::size_t FirstChunk = 32;
+
+        struct Chunk {
+            ServiceDescriptor *items;
+            std::size_t capacity;
+        };
+
+        void Grow(std::size_t capacity) {
+            chunks.reserve(chunks.size() + 1);
+            auto items = allocator.allocate(capacity);
+            std::uninitialized_value_construct_n(items, capacity);
+
+            chunks.push_back({items, capacity});
+            used = 0;
+        }
+
+        // Destroyed last, after the descriptors and what they own
+        std::shared_ptr<MemoryAccount> account;
+        std::pmr::polymorphic_allocator<ServiceDescriptor> allocator;
+        mutable std::mutex mutex;
+        std::vector<Chunk> chunks;
+        std::vector<ServiceDescriptor *> released;
+        std::size_t used = 0;
+        std::size_t count = 0;
+    };
+
+}
+
+#endif //INJECTTORTEST_SERVICEDESCRIPTOR_HPP
@@ -0,0 +1,815 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_SERVICEREGISTRY_HPP
+#define INJECTTORTEST_SERVICEREGISTRY_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "EpochReclaimer.hpp"
+#include "MemoryAccount.hpp"
+#include "ServiceDescriptor.hpp"
+#include "SingletonTable.hpp"
+
+namespace DI {
+
+    /**
+    * @struct ServiceEntry
+    *
+    * @brief The ServiceEntry struct is one registration of a ServiceGroup: a tag, and the descriptor registered under
+    * it.
+    *
+    * Entries never move once constructed. Their tag never changes once published, their descriptor is swapped
+    * atomically when the registration is overridden, and cleared when it is removed.
+    */
+    struct ServiceEntry {
+        ServiceEntry(std::size_t position, std::string_view tag, std::size_t hash,
+                     const CountingAllocator<char> &allocator)
+                : position(position), hash(hash), tag(tag, allocator) {}
+
+        ServiceDescriptor *Service() const {
+            return service.load(std::memory_order_acquire);
+        }
+
+        /**
+        * @return bool Whether the owning container registered the tag itself, as opposed to inheriting it.
+        */
+        bool Local() const {
+            return local.load(std::memory_order_acquire);
+        }
+
+        // Where the entry sits in registration order
+        const std::size_t position;
+        std::size_t hash;
+        CountedString tag;
+        std::atomic<ServiceDescriptor *> service{nullptr};
+        std::atomic<bool> local{false};
+    };
+
+    class ServiceGroup;
+
+    /**
+    * @brief Builds the ResolveAll result of a group of singletons, typed after their interface.
+    */
+    using CollectFnc = std::shared_ptr<void> (*)(const ServiceGroup &);
+
+    /**
+    * @class ServiceGroup
+    *
+    * @brief The ServiceGroup class holds every registration made for one interface type.
+    *
+    * Registrations are kept in registration order, in chunks that double in size and never move, and indexed by tag in
+    * an open-addressing table of pointers to them. Resolving all the implementations of an interface walks the chunks,
+    * so fan-out over plugins or middleware never rehashes the tags.
+    *
+    * Groups are updated in place, by one writer at a time, while readers keep going. A new registration is staged
+    * past the published size, where readers never look, and the size is published once the writer is done, so a
+    * registration costs the same whatever the number already in the group. Overriding a registration swaps the
+    * descriptor of its entry, removing it clears the descriptor and the entry is skipped from then on, until the tag
+    * is registered again. Growing the index builds a new one, the previous one is retired. Everything is charged to
+    * the account of the registry.
+    */
+    class ServiceGroup {
+    public:
+        /**
+        * @class Entries
+        *
+        * @brief The published entries of a group in registration order, removed ones skipped, to be walked inside an
+        * EpochReclaimer::ReadGuard.
+        *
+        * An entry removed while it is walked still comes up, without a descriptor.
+        */
+        class Entries final {
+        public:
+            class Iterator final {
+            public:
+                const ServiceEntry &operator*() const {
+                    return group->At(position);
+                }
+
+                Iterator &operator++() {
+                    position++;
+                    Skip();
+                    return *this;
+                }
+
+                bool operator!=(const Iterator &other) const {
+                    return position != other.position;
+                }
+
+            private:
+                friend Entries;
+
+                Iterator(const ServiceGroup *group, std::size_t position, std::size_t count)
+                        : group(group), position(position), count(count) {
+                    Skip();
+                }
+
+                void Skip() {
+                    while (position < count && !group->At(position).Service()) {
+                        position++;
+                    }
+                }
+
+                const ServiceGroup *group;
+                std::size_t position;
+                std::size_t count;
+            };
+
+            Iterator begin() const {
+                return {group, 0, count};
+            }
+
+            Iterator end() const {
+                return {group, count, count};
+            }
+
+            /**
+            * @return std::size_t The number of entries, removed ones included.
+            */
+            std::size_t size() const {
+                return count;
+            }
+
+        private:
+            friend ServiceGroup;
+
+            Entries(const ServiceGroup *group, std::size_t count) : group(group), count(count) {}
+
+            const ServiceGroup *group;
+            std::size_t count;
+        };
+
+        ServiceGroup(TypeId type, const char *typeName, const CountingAllocator<char> &allocator)
+                : type(type), typeName(typeName), allocator(allocator) {}
+
+        ~ServiceGroup() {
+            for (std::size_t position = 0; position < constructed; position++) {
+                std::destroy_at(&At(position));
+            }
+
+            for (std::size_t chunk = 0; chunk < Chunks; chunk++) {
+                if (auto items = chunks[chunk].load(std::memory_order_relaxed)) {
+                    allocator.deallocate(items, FirstChunk << chunk);
+                }
+            }
+
+            delete cache.load(std::memory_order_relaxed);
+        }
+
+        ServiceGroup(const ServiceGroup &) = delete;
+
+        ServiceGroup &operator=(const ServiceGroup &) = delete;
+
+        const TypeId type;
+
+        // The name of the interface, TypeInfo names are static
+        const char *const typeName;
+
+        Entries Published() const {
+            return {this, size.load(std::memory_order_acquire)};
+        }
+
+        /**
+        * @return const ServiceEntry* The published entry of the tag, nullptr if none.
+        */
+        const ServiceEntry *Find(std::string_view tag) const {
+            return Probe(tag, size.load(std::memory_order_acquire));
+        }
+
+        /**
+        * @brief The ResolveAll result of a group of singletons, built on the first call after the group changed.
+        *
+        * To be called inside an EpochReclaimer::ReadGuard. Results replaced by a newer one are retired through the
+        * reclaimer, callers holding them keep them alive.
+        */
+        std::shared_ptr<void> Instances(CollectFnc collect, EpochReclaimer &reclaimer) const {
+            auto current = revision.load(std::memory_order_acquire);
+            auto cached = cache.load(std::memory_order_acquire);
+            if (cached && cached->revision == current && cached->instances) {
+                return cached->instances;
+            }
+
+            // Built from what is published now, at least what the revision stands for
+            auto built = new InstanceCache{current, collect(*this)};
+            auto instances = built->instances;
+            if (cache.compare_exchange_strong(cached, built, std::memory_order_acq_rel)) {
+                if (cached) {
+                    reclaimer.Retire(std::shared_ptr<InstanceCache>(cached));
+                }
+            } else {
+                delete built;
+            }
+
+            return instances;
+        }
+
+        /*
+        * Writers only, the shard of the group being locked.
+        */
+
+        /**
+        * @return const ServiceEntry* The entry of the tag, published or staged by the current writer, nullptr if none.
+        */
+        const ServiceEntry *Staged(std::string_view tag) const {
+            return Probe(tag, staged);
+        }
+
+        /**
+        * @brief Registers a descriptor under a tag: overrides the entry of the tag right away, or stages a new one
+        * until Publish.
+        *
+        * @param local Whether the owning container registers the tag itself, which sticks once set.
+        */
+        void Set(std::string_view tag, ServiceDescriptor *descriptor, bool local) {
+            auto entry = const_cast<ServiceEntry *>(Staged(tag));
+            if (!entry) {
+                entry = &Append(tag);
+            }
+
+            entry->service.store(descriptor, std::memory_order_release);
+            if (local) {
+                entry->local.store(true, std::memory_order_release);
+            }
+
+            changed = true;
+        }
+
+        /**
+        * @brief Removes the registration of a tag. Its entry stays in place, to be reused if the tag is registered
+        * again.
+        *
+        * The ResolveAll result is replaced with an empty one right away: one built from what was published before
+        * can no longer be installed, and would keep the instances of the removed registration alive.
+        *
+        * @return std::shared_ptr<void> The ResolveAll result readers may still be using, nullptr if there was none.
+        */
+        [[nodiscard]] std::shared_ptr<void> Remove(std::string_view tag) {
+            auto entry = const_cast<ServiceEntry *>(Staged(tag));
+            if (!entry || !entry->Service()) {
+                return nullptr;
+            }
+
+            entry->service.store(nullptr, std::memory_order_release);
+            entry->local.store(false, std::memory_order_release);
+            changed = true;
+
+            auto stale = cache.exchange(new InstanceCache{0, nullptr}, std::memory_order_acq_rel);
+            return stale ? std::shared_ptr<InstanceCache>(stale) : nullptr;
+        }
+
+        /**
+        * @brief Makes the staged entries visible, and the ResolveAll results built before stale.
+        */
+        void Publish() {
+            touched = false;
+            if (changed) {
+                size.store(staged, std::memory_order_release);
+                revision.fetch_add(1, std::memory_order_acq_rel);
+                changed = false;
+            }
+        }
+
+        /**
+        * @brief Drops the staged entries, readers never saw them. Overrides stay.
+        */
+        void Rollback() {
+            touched = false;
+            staged = size.load(std::memory_order_relaxed);
+            changed = false;
+        }
+
+        /**
+        * @return std::shared_ptr<void> The index readers may still be using, if it had to grow.
+        */
+        [[nodiscard]] std::shared_ptr<void> Reserve(std::size_t entries) {
+            if (!entries) {
+                return nullptr;
+            }
+
+            for (auto chunk = ChunkOf(staged); chunk <= ChunkOf(staged + entries - 1); chunk++) {
+                if (!chunks[chunk].load(std::memory_order_relaxed)) {
+                    chunks[chunk].store(allocator.allocate(FirstChunk << chunk), std::memory_order_release);
+                }
+            }
+
+            if (index && (indexed + entries) * 2 <= index->slots.size()) {
+                return nullptr;
+            }
+
+            auto capacity = index ? index->slots.size() : FirstIndex;
+            while ((staged + entries) * 2 > capacity) {
+                capacity *= 2;
+            }
+
+            return Reindex(capacity);
+        }
+
+        /**
+        * @brief The index readers may still be using, once replaced by a larger one.
+        */
+        std::shared_ptr<void> TakeRetired() {
+            return std::move(retired);
+        }
+
+    private:
+        static constexpr std::size_t FirstChunk = 8;
+        static constexpr std::size_t Chunks = 48;
+        static constexpr std::size_t FirstIndex = 16;
+
+        struct Index {
+            Index(std::size_t capacity, const CountingAllocator<char> &allocator) : slots(capacity, allocator) {}
+
+            CountedVector<std::atomic<ServiceEntry *>> slots;
+        };
+
+        // A result without instances is to be built, whatever its revision
+        struct InstanceCache {
+            std::size_t revision;
+            std::shared_ptr<void> instances;
+        };
+
+        /**
+        * @return int The chunk holding the entry at the position, chunk n holding FirstChunk << n entries.
+        */
+        static int ChunkOf(std::size_t position) {
+            return std::bit_width(position + FirstChunk) - std::bit_width(FirstChunk);
+        }
+
+        const ServiceEntry &At(std::size_t position) const {
+            auto chunk = ChunkOf(position);
+            return chunks[chunk].load(std::memory_order_acquire)[position + FirstChunk - (FirstChunk << chunk)];
+        }
+
+        ServiceEntry &At(std::size_t position) {
+            return const_cast<ServiceEntry &>(std::as_const(*this).At(position));
+        }
+
+        const ServiceEntry *Probe(std::string_view tag, std::size_t count) const {
+            auto current = view.load(std::memory_order_acquire);
+            if (!count || !current) {
+                return nullptr;
+            }
+
+            auto hash = std::hash<std::string_view>()(tag);
+            auto mask = current->slots.size() - 1;
+            for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+                auto entry = current->slots[slot].load(std::memory_order_acquire);
+                if (!entry) {
+                    return nullptr;
+                }
+
+                // Entries past the count may be staged, or rolled back and rewritten, their fields are not read
+                if (entry->position < count && entry->hash == hash && std::string_view(entry->tag) == tag) {
+                    return entry;
+                }
+            }
+        }
+
+        ServiceEntry &Append(std::string_view tag) {
+            if (auto grown = Reserve(1)) {
+                retired = std::move(grown);
+            }
+
+            auto hash = std::hash<std::string_view>()(tag);
+            auto position = staged;
+            if (position < constructed) {
+                // Rolled back earlier, readers never look at it
+                auto &entry = At(position);
+                entry.tag.assign(tag);
+                entry.hash = hash;
+                entry.local.store(false, std::memory_order_relaxed);
+                Insert(*index, entry);
+            } else {
+                Insert(*index, *std::construct_at(&At(position), position, tag, hash, allocator));
+                constructed++;
+            }
+
+            staged++;
+            indexed++;
+            return At(position);
+        }
+
+        static void Insert(Index &target, ServiceEntry &entry) {
+            auto mask = target.slots.size() - 1;
+            for (auto slot = entry.hash & mask;; slot = (slot + 1) & mask) {
+                if (!target.slots[slot].load(std::memory_order_relaxed)) {
+                    target.slots[slot].store(&entry, std::memory_order_release);
+                    return;
+                }
+            }
+        }
+
+        std::shared_ptr<void> Reindex(std::size_t capacity) {
+            auto grown = std::allocate_shared<Index>(allocator, capacity, allocator);
+            for (std::size_t position = 0; position < staged; position++) {
+                Insert(*grown, At(position));
+            }
+
+            indexed = staged;
+            view.store(grown.get(), std::memory_order_release);
+            std::swap(index, grown);
+            return grown;
+        }
+
+        CountingAllocator<ServiceEntry> allocator;
+        std::array<std::atomic<ServiceEntry *>, Chunks> chunks{};
+        std::shared_ptr<Index> index;
+        std::atomic<const Index *> view{nullptr};
+
+        // Published entries, the others are staged by the current writer or rolled back
+        std::atomic<std::size_t> size{0};
+
+        // Bumped every time the group changes, ResolveAll results are built for one revision
+        std::atomic<std::size_t> revision{0};
+        mutable std::atomic<InstanceCache *> cache{nullptr};
+
+        // Writers only: entries staged, constructed, and in the index, stale ones included
+        std::size_t staged = 0;
+        std::size_t constructed = 0;
+        std::size_t indexed = 0;
+        bool changed = false;
+        bool touched = false;
+        std::shared_ptr<void> retired;
+
+        friend class ServiceRegistry;
+    };
+
+    /**
+    * @class ServiceRegistry
+    *
+    * @brief The ServiceRegistry class indexes the registrations of one lifetime, split in shards by type.
+    *
+    * Each shard owns the groups of the types hashed to it, in an open-addressing table, and, for singletons, the flat
+    * table of their instances. Resolves never lock: they read the current table of a shard from an atomic pointer,
+    * inside an EpochReclaimer::ReadGuard. Writers lock the shard of the type they register and update its group in
+    * place, see ServiceGroup: a registration never copies what is already registered, only the tables that grow are
+    * rebuilt and the previous ones retired. Registrations of types living in different shards therefore never wait for
+    * each other, and never wait for resolves.
+    *
+    * Everything the registry allocates is charged to the MemoryAccount it is constructed with, if any.
+    */
+    class ServiceRegistry {
+        struct Shard;
+
+        /**
+        * @brief Retires what writers replaced once their shards are unlocked, destructors must not find them locked.
+        */
+        struct Retirement {
+            EpochReclaimer &reclaimer;
+            std::vector<std::shared_ptr<void>> objects;
+
+            ~Retirement() {
+                for (auto &object: objects) {
+                    if (object) {
+                        reclaimer.Retire(std::move(object));
+                    }
+                }
+            }
+        };
+
+    public:
+        static constexpr std::size_t ShardCount = 16;
+
+        /**
+        * @class Writer
+        *
+        * @brief The Writer class is the view of one locked shard while it is being updated.
+        *
+        * The staged registrations are published when the update completes, or dropped when it throws.
+        */
+        class Writer final {
+        public:
+            ~Writer() {
+                for (auto group: touched) {
+                    group->Rollback();
+                }
+            }
+
+            Writer(const Writer &) = delete;
+
+            Writer &operator=(const Writer &) = delete;
+
+            /**
+            * @return const ServiceGroup* The group of the type, with what is staged, nullptr if none.
+            */
+            const ServiceGroup *Find(TypeId type) const {
+                return shard.table ? Lookup(*shard.table, type) : nullptr;
+            }
+
+            /**
+            * @return ServiceGroup& The group of the type, created if needed.
+            */
+            ServiceGroup &Group(TypeId type, const char *typeName) {
+                auto group = const_cast<ServiceGroup *>(Find(type));
+                if (!group) {
+                    group = &Create(type, typeName);
+                }
+
+                if (!group->touched) {
+                    group->touched = true;
+                    touched.push_back(group);
+                }
+
+                return *group;
+            }
+
+            /**
+            * @brief Makes room in the group of the type for the given number of new registrations.
+            */
+            void Reserve(TypeId type, const char *typeName, std::size_t registrations) {
+                Retire(Group(type, typeName).Reserve(registrations));
+            }
+
+            /**
+            * @return SingletonTable& The singleton table of the shard, modified in place.
+            */
+            SingletonTable &Singletons() {
+                return shard.singletons;
+            }
+
+            /**
+            * @brief Retires an object through the EpochReclaimer once the shard is unlocked.
+            */
+            void Retire(std::shared_ptr<void> object) {
+                if (object) {
+                    retired.push_back(std::move(object));
+                }
+            }
+
+        private:
+            friend ServiceRegistry;
+
+            Writer(Shard &shard, const CountingAllocator<char> &allocator, std::vector<std::shared_ptr<void>> &retired)
+                    : shard(shard), allocator(allocator), retired(retired) {}
+
+            ServiceGroup &Create(TypeId type, const char *typeName) {
+                auto &table = shard.table;
+                if (!table || (table->groups.size() + 1) * 2 > table->slots.size()) {
+                    auto grown = std::allocate_shared<GroupTable>(
+                            allocator, table ? table->slots.size() * 2 : FirstGroups, allocator);
+                    if (table) {
+                        grown->groups = std::move(table->groups);
+                        for (auto &group: grown->groups) {
+                            Insert(*grown, group.get());
+                        }
+                    }
+
+                    shard.view.store(grown.get(), std::memory_order_release);
+                    std::swap(table, grown);
+                    Retire(std::move(grown));
+                }
+
+                auto group = std::allocate_shared<ServiceGroup>(allocator, type, typeName, allocator);
+                table->groups.push_back(group);
+                Insert(*table, group.get());
+                return *group;
+            }
+
+            void Commit() {
+                for (auto group: touched) {
+                    group->Publish();
+                    Retire(group->TakeRetired());
+                }
+
+                touched.clear();
+            }
+
+            Shard &shard;
+            CountingAllocator<char> allocator;
+            std::vector<std::shared_ptr<void>> &retired;
+            std::vector<ServiceGroup *> touched;
+        };
+
+        /**
+        * @class Transaction
+        *
+        * @brief The Transaction class locks shards of one or more registries, and publishes what their writers staged
+        * once all of them are done.
+        *
+        * Shards must be opened in one global order by every transaction: registries in a fixed order, then shards by
+        * index. Writers updating a single shard only ever hold one lock, and cannot deadlock with it. A transaction
+        * destroyed before Commit publishes nothing new, overrides aside.
+        */
+        class Transaction final {
+        public:
+            explicit Transaction(EpochReclaimer &reclaimer) : retirement{reclaimer} {}
+
+            Transaction(const Transaction &) = delete;
+
+            Transaction &operator=(const Transaction &) = delete;
+
+            /**
+            * @brief Locks a shard of a registry, after the ones opened before it.
+            */
+            Writer &Open(ServiceRegistry &registry, std::size_t index) {
+                auto &shard = registry.shards[index];
+                locks.emplace_back(shard.mutex);
+                writers.emplace_back(new Writer(shard, registry.Allocator(), retirement.objects));
+                return *writers.back();
+            }
+
+            /**
+            * @brief Publishes the registrations staged by every writer, shard by shard, all shards still locked.
+            */
+            void Commit() {
+                for (auto &writer: writers) {
+                    writer->Commit();
+                }
+            }
+
+        private:
+            // Destroyed in reverse: writers roll back under the locks, which are released before anything is retired
+            Retirement retirement;
+            std::vector<std::unique_lock<std::mutex>> locks;
+            std::vector<std::unique_ptr<Writer>> writers;
+        };
+
+        explicit ServiceRegistry(MemoryAccount *account = nullptr) : account(account) {
+            for (auto &shard: shards) {
+                shard.singletons.SetAccount(account);
+            }
+        }
+
+        ServiceRegistry(const ServiceRegistry &) = delete;
+
+        ServiceRegistry &operator=(const ServiceRegistry &) = delete;
+
+        /**
+        * @brief Looks up the group of a type, to be called inside an EpochReclaimer::ReadGuard.
+        *
+        * @return const ServiceGroup* The group, nullptr if nothing is published for the type.
+        */
+        const ServiceGroup *Find(TypeId type) const {
+            auto table = shards[ShardOf(type)].view.load(std::memory_order_acquire);
+            auto group = table ? Lookup(*table, type) : nullptr;
+            return group && group->Published().size() ? group : nullptr;
+        }
+
+        /**
+        * @brief The singleton table holding the type, to be called inside an EpochReclaimer::ReadGuard.
+        */
+        const SingletonTable &Singletons(TypeId type) const {
+            return shards[ShardOf(type)].singletons;
+        }
+
+        /**
+        * @brief Updates the shard holding a type under its lock, and publishes the result.
+        *
+        * When the update throws nothing new is published.
+        *
+        * @param update Called with the Writer of the shard.
+        */
+        template<typename TUpdate>
+        void Update(TypeId type, EpochReclaimer &reclaimer, TUpdate &&update) {
+            UpdateShard(ShardOf(type), reclaimer, update);
+        }
+
+        template<typename TUpdate>
+        void UpdateShard(std::size_t index, EpochReclaimer &reclaimer, TUpdate &&update) {
+            Transaction transaction(reclaimer);
+            update(transaction.Open(*this, index));
+            transaction.Commit();
+        }
+
+        /**
+        * @brief Visits every group with published registrations, to be called inside an EpochReclaimer::ReadGuard.
+        */
+        template<typename TVisitor>
+        void ForEach(TVisitor &&visitor) const {
+            for (auto &shard: shards) {
+                auto table = shard.view.load(std::memory_order_acquire);
+                if (!table) {
+                    continue;
+                }
+
+                for (auto &slot: table->slots) {
+                    auto group = slot.load(std::memory_order_acquire);
+                    if (group && group->Published().size()) {
+                        visitor(group->type, *group);
+                    }
+                }
+            }
+        }
+
+        /**
+        * @brief Copies every registration of a parent registry, as inherited ones.
+        */
+        void Inherit(const ServiceRegistry &parent, EpochReclaimer &reclaimer) {
+            for (std::size_t index = 0; index < ShardCount; index++) {
+                auto &source = parent.shards[index];
+                std::lock_guard<std::mutex> lock(source.mutex);
+                if (!source.table) {
+                    continue;
+                }
+
+                UpdateShard(index, reclaimer, [&source](Writer &writer) {
+                    for (auto &group: source.table->groups) {
+                        auto entries = group->Published();
+                        writer.Reserve(group->type, group->typeName, entries.size());
+
+                        auto &copy = writer.Group(group->type, group->typeName);
+                        for (auto &entry: entries) {
+                            copy.Set(entry.tag, entry.Service(), false);
+                        }
+                    }
+
+                    writer.Retire(writer.Singletons().Assign(source.singletons));
+                });
+            }
+        }
+
+        /**
+        * @brief Removes one registration, and its singleton instance if any.
+        */
+        void Remove(TypeId type, std::string_view tag, EpochReclaimer &reclaimer) {
+            Update(type, reclaimer, [type, tag](Writer &writer) {
+                if (auto group = writer.Find(type)) {
+                    writer.Retire(writer.Group(type, group->typeName).Remove(tag));
+                    writer.Retire(writer.Singletons().Remove(type, tag));
+                }
+            });
+        }
+
+        /**
+        * @brief Removes every registration.
+        */
+        void Clear(EpochReclaimer &reclaimer) {
+            for (auto &shard: shards) {
+                Retirement retirement{reclaimer};
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                shard.view.store(nullptr, std::memory_order_release);
+                retirement.objects.push_back(std::move(shard.table));
+                retirement.objects.push_back(shard.singletons.Clear());
+            }
+        }
+
+        static std::size_t ShardOf(TypeId type) {
+            auto hash = std::hash<TypeId>()(type);
+            return (hash ^ (hash >> 7) ^ (hash >> 13)) & (ShardCount - 1);
+        }
+
+    private:
+        static constexpr std::size_t FirstGroups = 8;
+
+        /**
+        * @brief The groups of a shard, indexed by type. A larger table takes over the groups when it grows.
+        */
+        struct GroupTable {
+            GroupTable(std::size_t capacity, const CountingAllocator<char> &allocator)
+                    : slots(capacity, allocator), groups(allocator) {}
+
+            CountedVector<std::atomic<ServiceGroup *>> slots;
+
+            // Writers only, the groups the table owns
+            CountedVector<std::shared_ptr<ServiceGroup>> groups;
+        };
+
+        struct Shard {
+            // Serializes the writers of the shard, resolves never take it
+            mutable std::mutex mutex;
+            std::shared_ptr<GroupTable> table;
+            std::atomic<const GroupTable *> view{nullptr};
+            SingletonTable singletons;
+        };
+
+        static const ServiceGroup *Lookup(const GroupTable &table, TypeId type) {
+            auto mask = table.slots.size() - 1;
+            for (auto slot = type.Hash() & mask;; slot = (slot + 1) & mask) {
+                auto group = table.slots[slot].load(std::memory_order_acquire);
+                if (!group || group->type == type) {
+                    return group;
+                }
+            }
+        }
+
+        static void Insert(GroupTable &table, ServiceGroup *group) {
+            auto mask = table.slots.size() - 1;
+            for (auto slot = group->type.Hash() & mask;; slot = (slot + 1) & mask) {
+                if (!table.slots[slot].load(std::memory_order_relaxed)) {
+                    table.slots[slot].store(group, std::memory_order_release);
+                    return;
+                }
+            }
+        }
+
+        CountingAllocator<char> Allocator() const {
+            return {account, MemoryCategory::Registry};
+        }
+
+        MemoryAccount *account;
+        std::array<Shard, ShardCount> shards;
+    };
+
+}
+
+#endif //INJECTTORTEST_SERVICEREGISTRY_HPP
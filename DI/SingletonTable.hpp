@@ -0,0 +1,248 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_SINGLETONTABLE_HPP
+#define INJECTTORTEST_SINGLETONTABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <scoped_allocator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MemoryAccount.hpp"
+#include "ServiceDescriptor.hpp"
+
+namespace DI {
+
+    /**
+    * @class SingletonTable
+    *
+    * @brief The SingletonTable class is a flat, open-addressing index of the singleton instances of a container.
+    *
+    * Each slot holds the key next to the instance pointer and its control block, so a resolve hit reads a single slot
+    * and never follows a pointer to a map node or to a descriptor. The table is kept at most half full and probed
+    * linearly.
+    *
+    * New registrations fill an empty slot in place and publish its type last, so readers see the slot either empty
+    * or complete. Overriding, replacing or removing a registration, growing and clearing never modify slots readers
+    * may be looking at: they build a new block of slots and publish it atomically. The previous block is handed back to the
+    * caller, to be released once no reader uses it anymore. Writers must be serialized by the caller.
+    */
+    class SingletonTable {
+    public:
+        struct Slot {
+            // Tags are allocated from the allocator of the table holding the slot
+            using allocator_type = CountingAllocator<char>;
+
+            std::size_t hash = 0;
+            std::atomic<TypeId> type{nullptr};
+            std::shared_ptr<void> instance;
+
+            // Per-node singletons only, the replicas the instance is the first of
+            const ReplicaSet *replicas = nullptr;
+            const ServiceDescriptor *descriptor = nullptr;
+            CountedString tag;
+
+            explicit Slot(const allocator_type &allocator) : tag(allocator) {}
+
+            Slot(const Slot &other, const allocator_type &allocator)
+                    : hash(other.hash), type(other.type.load(std::memory_order_relaxed)), instance(other.instance),
+                      replicas(other.replicas), descriptor(other.descriptor), tag(other.tag, allocator) {}
+
+            Slot &operator=(const Slot &other) {
+                hash = other.hash;
+                instance = other.instance;
+                replicas = other.replicas;
+                descriptor = other.descriptor;
+                tag = other.tag;
+                type.store(other.type.load(std::memory_order_relaxed), std::memory_order_release);
+                return *this;
+            }
+        };
+
+        SingletonTable() = default;
+
+        SingletonTable(const SingletonTable &other)
+                : allocator(other.allocator),
+                  block(other.block ? std::allocate_shared<Block>(allocator, *other.block) : nullptr),
+                  view(block.get()) {}
+
+        SingletonTable &operator=(const SingletonTable &) = delete;
+
+        /**
+        * @brief Charges the slots of the table to an account from now on, to be called while the table is empty.
+        */
+        void SetAccount(MemoryAccount *account) {
+            allocator = {account, MemoryCategory::SingletonTable};
+        }
+
+        /**
+        * @return const Slot* The slot of the given type and tag, nullptr when it is not registered.
+        */
+        const Slot *Find(TypeId type, std::string_view tag) const {
+            auto current = view.load(std::memory_order_acquire);
+            if (!current) {
+                return nullptr;
+            }
+
+            auto hash = Hash(type, tag);
+            for (auto index = hash & current->mask;; index = (index + 1) & current->mask) {
+                auto &slot = current->slots[index];
+                auto slotType = slot.type.load(std::memory_order_acquire);
+                if (!slotType) {
+                    return nullptr;
+                }
+
+                if (slot.hash == hash && slotType == type && std::string_view(slot.tag) == tag) {
+                    return &slot;
+                }
+            }
+        }
+
+        /**
+        * @brief Stores the instance of a registration, replacing the one registered with the same type and tag.
+        *
+        * @return std::shared_ptr<void> The block of slots readers may still be using, nullptr when the table was
+        * updated in place.
+        */
+        [[nodiscard]] std::shared_ptr<void> Set(TypeId type, std::string_view tag, const ServiceDescriptor *descriptor) {
+            auto hash = Hash(type, tag);
+            if (block && Probe(*block, hash, type, tag).type.load(std::memory_order_relaxed)) {
+                auto copy = std::allocate_shared<Block>(allocator, *block);
+                Fill(Probe(*copy, hash, type, tag), hash, type, tag, descriptor);
+                return Publish(std::move(copy));
+            }
+
+            std::shared_ptr<void> previous;
+            if (!block || (block->count + 1) * 2 > block->slots.size()) {
+                previous = Rebuild(block ? block->slots.size() * 2 : FirstCapacity);
+            }
+
+            Fill(Probe(*block, hash, type, tag), hash, type, tag, descriptor);
+            block->count++;
+            return previous;
+        }
+
+        /**
+        * @brief Makes room for the given number of new registrations, so that adding them does not rehash.
+        *
+        * @return std::shared_ptr<void> The block of slots readers may still be using, if it had to grow.
+        */
+        [[nodiscard]] std::shared_ptr<void> Reserve(std::size_t registrations) {
+            auto size = block ? block->slots.size() : 0;
+            auto capacity = size ? size : FirstCapacity;
+            while (((block ? block->count : 0) + registrations) * 2 > capacity) {
+                capacity *= 2;
+            }
+
+            return capacity != size ? Rebuild(capacity) : nullptr;
+        }
+
+        /**
+        * @brief Removes the instance of a registration, the others keep their slots in a new block.
+        *
+        * @return std::shared_ptr<void> The block of slots readers may still be using, nullptr when nothing was
+        * registered with the type and tag.
+        */
+        [[nodiscard]] std::shared_ptr<void> Remove(TypeId type, std::string_view tag) {
+            if (!block) {
+                return nullptr;
+            }
+
+            auto &slot = Probe(*block, Hash(type, tag), type, tag);
+            return slot.type.load(std::memory_order_relaxed) ? Rebuild(block->slots.size(), &slot) : nullptr;
+        }
+
+        /**
+        * @brief Replaces the content of the table with a copy of another table.
+        *
+        * @return std::shared_ptr<void> The block of slots readers may still be using.
+        */
+        [[nodiscard]] std::shared_ptr<void> Assign(const SingletonTable &other) {
+            if (!other.block) {
+                return Publish(nullptr);
+            }
+
+            auto &source = *other.block;
+            return Publish(std::allocate_shared<Block>(allocator, Block{Slots(source.slots, allocator), source.mask,
+                                                                        source.count}));
+        }
+
+        /**
+        * @return std::shared_ptr<void> The block of slots readers may still be using.
+        */
+        [[nodiscard]] std::shared_ptr<void> Clear() {
+            return Publish(nullptr);
+        }
+
+    private:
+        static constexpr std::size_t FirstCapacity = 16;
+
+        // Slots, and their tags, are allocated from the allocator of the vector holding them, copies included
+        using Slots = std::vector<Slot, std::scoped_allocator_adaptor<CountingAllocator<Slot>>>;
+
+        struct Block {
+            Slots slots;
+            std::size_t mask;
+            std::size_t count;
+        };
+
+        static std::size_t Hash(TypeId type, std::string_view tag) {
+            auto hash = std::hash<TypeId>()(type) ^ (std::hash<std::string_view>()(tag) * 0x9E3779B97F4A7C15ull);
+            return hash ^ (hash >> 29);
+        }
+
+        static Slot &Probe(Block &target, std::size_t hash, TypeId type, std::string_view tag) {
+            for (auto index = hash & target.mask;; index = (index + 1) & target.mask) {
+                auto &slot = target.slots[index];
+                auto slotType = slot.type.load(std::memory_order_relaxed);
+                if (!slotType || (slot.hash == hash && slotType == type && std::string_view(slot.tag) == tag)) {
+                    return slot;
+                }
+            }
+        }
+
+        static void Fill(Slot &slot, std::size_t hash, TypeId type, std::string_view tag,
+                         const ServiceDescriptor *descriptor) {
+            slot.tag.assign(tag);
+            slot.instance = descriptor->instance;
+            slot.replicas = descriptor->replicas.get();
+            slot.descriptor = descriptor;
+            slot.hash = hash;
+            slot.type.store(type, std::memory_order_release);
+        }
+
+        /**
+        * @brief Moves the slots to a new block of the given capacity, all but the removed one if any.
+        */
+        std::shared_ptr<void> Rebuild(std::size_t capacity, const Slot *removed = nullptr) {
+            auto rebuilt = std::allocate_shared<Block>(allocator, Block{Slots(capacity, allocator), capacity - 1, 0});
+            if (block) {
+                for (auto &slot: block->slots) {
+                    auto type = slot.type.load(std::memory_order_relaxed);
+                    if (type && &slot != removed) {
+                        Probe(*rebuilt, slot.hash, type, slot.tag) = slot;
+                        rebuilt->count++;
+                    }
+                }
+            }
+
+            return Publish(std::move(rebuilt));
+        }
+
+        std::shared_ptr<void> Publish(std::shared_ptr<Block> next) {
+            view.store(next.get(), std::memory_order_release);
+            std::swap(block, next);
+            return next;
+        }
+
+        CountingAllocator<Slot> allocator{nullptr, MemoryCategory::SingletonTable};
+        std::shared_ptr<Block> block;
+        std::atomic<Block *> view{nullptr};
+    };
+
+}
+
+#endif //INJECTTORTEST_SINGLETONTABLE_HPP
@@ -0,0 +1,240 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_THREADLOCALSTORE_HPP
+#define INJECTTORTEST_THREADLOCALSTORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DI {
+
+    /**
+    * @struct ThreadInstances
+    *
+    * @brief The ThreadInstances struct counts the thread-local instances one thread holds for a container.
+    */
+    struct ThreadInstances {
+        std::thread::id thread;
+        std::size_t instances;
+        std::size_t bytes;          // by the size of their implementation
+    };
+
+    class ThreadSlot;
+
+    /**
+    * @class ThreadLocalStore
+    *
+    * @brief The ThreadLocalStore class holds the instances of thread-local services created by the current thread.
+    *
+    * Every thread-local registration owns a process-wide ThreadSlot, and every thread a vector of instances indexed
+    * by slot, so a resolve hit is a bounds check and two loads from thread-local memory. The store of a thread goes
+    * away when the thread exits, releasing its instances, last slot first. Only its own thread modifies a store, under
+    * its mutex, which Snapshot takes to count the instances of every thread.
+    *
+    * Slot numbers are recycled once their registration is gone, replaced or destroyed along with its container.
+    * Instances a thread still holds in a recycled slot belong to an older generation of the slot: they are never
+    * handed out again, and are released when the thread stores an instance of the new owner there, or exits.
+    */
+    class ThreadLocalStore {
+    public:
+        static ThreadLocalStore &Local() {
+            thread_local ThreadLocalStore store;
+            return store;
+        }
+
+        ThreadLocalStore(const ThreadLocalStore &) = delete;
+
+        ThreadLocalStore &operator=(const ThreadLocalStore &) = delete;
+
+        /**
+        * @return const std::shared_ptr<void>* The instance of the slot created by this thread, nullptr if none.
+        */
+        inline const std::shared_ptr<void> *Find(const ThreadSlot &slot) const;
+
+        inline void Store(const ThreadSlot &slot, std::uint64_t owner, std::size_t bytes,
+                          std::shared_ptr<void> instance);
+
+        /**
+        * @return std::vector<ThreadInstances> The threads holding instances of the container, with their count.
+        */
+        static std::vector<ThreadInstances> Snapshot(std::uint64_t owner) {
+            std::vector<ThreadInstances> threads;
+            auto &registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (auto store: registry.stores) {
+                ThreadInstances counts{store->thread, 0, 0};
+                std::lock_guard<std::mutex> storeLock(store->mutex);
+                for (std::size_t index = 0; index < store->entries.size(); index++) {
+                    auto &entry = store->entries[index];
+                    if (entry.instance && entry.owner == owner && entry.generation == registry.generations[index]) {
+                        counts.instances++;
+                        counts.bytes += entry.bytes;
+                    }
+                }
+
+                if (counts.instances) {
+                    threads.push_back(counts);
+                }
+            }
+
+            return threads;
+        }
+
+    private:
+        friend ThreadSlot;
+
+        struct Entry {
+            std::shared_ptr<void> instance;
+            std::uint64_t owner = 0;
+            std::uint64_t generation = 0;
+            std::size_t bytes = 0;
+        };
+
+        struct Stores {
+            std::mutex mutex;
+            std::vector<ThreadLocalStore *> stores;
+
+            // The generation currently owning each slot number, 0 when it is free
+            std::vector<std::uint64_t> generations;
+            std::vector<std::size_t> released;
+            std::uint64_t nextGeneration = 1;
+        };
+
+        ThreadLocalStore() {
+            auto &registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.stores.push_back(this);
+        }
+
+        ~ThreadLocalStore() {
+            {
+                auto &registry = Registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.stores.erase(std::find(registry.stores.begin(), registry.stores.end(), this));
+            }
+
+            std::vector<Entry> released;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                released.swap(entries);
+            }
+
+            for (auto entry = released.rbegin(); entry != released.rend(); ++entry) {
+                entry->instance.reset();
+            }
+        }
+
+        // Never destroyed, threads may exit, and slots be released, after the static objects are gone
+        static Stores &Registry() {
+            static auto stores = new Stores();
+            return *stores;
+        }
+
+        const std::thread::id thread = std::this_thread::get_id();
+        mutable std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    /**
+    * @class ThreadSlot
+    *
+    * @brief The ThreadSlot class owns a slot number of every ThreadLocalStore, and releases it when destroyed.
+    */
+    class ThreadSlot final {
+    public:
+        ThreadSlot() = default;
+
+        ThreadSlot(ThreadSlot &&other) noexcept : index(other.index), generation(other.generation) {
+            other.generation = 0;
+        }
+
+        ThreadSlot &operator=(ThreadSlot &&other) noexcept {
+            if (this != &other) {
+                Release();
+                index = other.index;
+                generation = other.generation;
+                other.generation = 0;
+            }
+
+            return *this;
+        }
+
+        ~ThreadSlot() {
+            Release();
+        }
+
+        /**
+        * @return ThreadSlot A slot number no live registration owns, with a generation of its own.
+        */
+        static ThreadSlot Acquire() {
+            auto &registry = ThreadLocalStore::Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            ThreadSlot slot;
+            if (registry.released.empty()) {
+                slot.index = registry.generations.size();
+                registry.generations.push_back(0);
+            } else {
+                slot.index = registry.released.back();
+                registry.released.pop_back();
+            }
+
+            slot.generation = registry.nextGeneration++;
+            registry.generations[slot.index] = slot.generation;
+            return slot;
+        }
+
+    private:
+        friend ThreadLocalStore;
+
+        void Release() {
+            if (!generation) {
+                return;
+            }
+
+            auto &registry = ThreadLocalStore::Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.generations[index] = 0;
+            registry.released.push_back(index);
+            generation = 0;
+        }
+
+        std::size_t index = 0;
+
+        // 0 when the slot owns no number
+        std::uint64_t generation = 0;
+    };
+
+    const std::shared_ptr<void> *ThreadLocalStore::Find(const ThreadSlot &slot) const {
+        if (slot.index >= entries.size()) {
+            return nullptr;
+        }
+
+        auto &entry = entries[slot.index];
+        return entry.instance && entry.generation == slot.generation ? &entry.instance : nullptr;
+    }
+
+    void ThreadLocalStore::Store(const ThreadSlot &slot, std::uint64_t owner, std::size_t bytes,
+                                 std::shared_ptr<void> instance) {
+        // An instance of an older generation of the slot is released once the lock is no longer held
+        Entry previous;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slot.index >= entries.size()) {
+                entries.resize(std::max(slot.index + 1, entries.size() * 2));
+            }
+
+            previous = std::move(entries[slot.index]);
+            entries[slot.index] = {std::move(instance), owner, slot.generation, bytes};
+        }
+    }
+
+}
+
+#endif //INJECTTORTEST_THREADLOCALSTORE_HPP
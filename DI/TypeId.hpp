@@ -0,0 +1,194 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_TYPEID_HPP
+#define INJECTTORTEST_TYPEID_HPP
+
+// Type identity relies on RTTI when it is enabled, and on compile-time identifiers otherwise, for builds with -fno-rtti
+#ifndef INJECTTOR_RTTI
+#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define INJECTTOR_RTTI 1
+#else
+#define INJECTTOR_RTTI 0
+#endif
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+#if INJECTTOR_RTTI
+#include <typeinfo>
+#else
+#include <array>
+#endif
+
+namespace DI {
+
+    /**
+    * @struct TypeInfo
+    *
+    * @brief The TypeInfo struct names a type, and holds the hash its identity is looked up by.
+    *
+    * There is one TypeInfo per type in each shared object using it: a plugin and its host, or two libraries built
+    * with -fvisibility=hidden, may well hold one each for the same type. Their addresses therefore do not identify the
+    * type, TypeId compares them first and falls back on the type itself when they differ.
+    */
+    struct TypeInfo {
+#if INJECTTOR_RTTI
+        const std::type_info *type;
+#else
+        const char *text;
+
+        // Types of anonymous namespaces are only equal to themselves, whatever their name
+        bool local;
+#endif
+        std::size_t hash;
+
+        const char *name() const {
+#if INJECTTOR_RTTI
+            return type->name();
+#else
+            return text;
+#endif
+        }
+
+        /**
+        * @return bool Whether the two records describe the same type, to be called when their addresses differ.
+        */
+        bool Same(const TypeInfo &other) const {
+#if INJECTTOR_RTTI
+            // Compares the mangled names unless the ABI merges type_info objects, see std::type_info::operator==
+            return hash == other.hash && *type == *other.type;
+#else
+            return hash == other.hash && !local && !other.local && std::strcmp(text, other.text) == 0;
+#endif
+        }
+    };
+
+#if !INJECTTOR_RTTI
+
+    /**
+    * @brief FNV-1a, computed at compile time.
+    */
+    constexpr std::size_t HashName(std::string_view name) {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        for (auto character: name) {
+            hash = (hash ^ static_cast<unsigned char>(character)) * 0x100000001B3ull;
+        }
+
+        return static_cast<std::size_t>(hash);
+    }
+
+    template<class T>
+    constexpr const char *FunctionSignature() {
+#if defined(_MSC_VER)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
+    /**
+    * @brief The name the compiler spells for a type in function signatures, extracted at compile time.
+    */
+    template<class T>
+    struct TypeName {
+        static constexpr std::string_view signature = FunctionSignature<T>();
+#if defined(_MSC_VER)
+        static constexpr std::size_t begin = signature.find("FunctionSignature<") + 18;
+        static constexpr std::size_t end = signature.rfind(">(void)");
+#else
+        static constexpr std::size_t begin = signature.find("T = ") + 4;
+        static constexpr std::size_t end = signature.rfind(']');
+#endif
+
+        static constexpr std::array<char, end - begin + 1> text = [] {
+            std::array<char, end - begin + 1> name{};
+            for (std::size_t i = begin; i < end; i++) {
+                name[i - begin] = signature[i];
+            }
+
+            return name;
+        }();
+
+        static constexpr bool local = signature.substr(begin, end - begin).find("anonymous namespace") !=
+                                      std::string_view::npos;
+    };
+
+#endif
+
+    /**
+    * @class TypeId
+    *
+    * @brief The TypeId class is the identity of a type, as used by the registries, the resolve cache and the scopes.
+    *
+    * A TypeId is a pointer to the TypeInfo of the type, as cheap to copy and to store atomically as one. Two TypeIds
+    * are equal when they point to the same TypeInfo, or else to TypeInfos of the same type: a type registered from a
+    * plugin resolves from the host. Hashes only depend on the type, never on the address.
+    */
+    class TypeId {
+    public:
+        constexpr TypeId(std::nullptr_t = nullptr) noexcept {}
+
+        constexpr explicit TypeId(const TypeInfo *info) noexcept : info(info) {}
+
+        const TypeInfo *operator->() const noexcept {
+            return info;
+        }
+
+        explicit operator bool() const noexcept {
+            return info != nullptr;
+        }
+
+        std::size_t Hash() const noexcept {
+            return info ? info->hash : 0;
+        }
+
+        friend bool operator==(TypeId left, TypeId right) noexcept {
+            return left.info == right.info || (left.info && right.info && left.info->Same(*right.info));
+        }
+
+        /**
+        * @brief Orders types by hash, then by name, consistently with operator==.
+        */
+        friend bool operator<(TypeId left, TypeId right) noexcept {
+            if (left.Hash() != right.Hash()) {
+                return left.Hash() < right.Hash();
+            }
+
+            if (left == right) {
+                return false;
+            }
+
+            auto order = left.info && right.info ? std::strcmp(left->name(), right->name()) : 0;
+            return order ? order < 0 : std::less<const TypeInfo *>()(left.info, right.info);
+        }
+
+    private:
+        const TypeInfo *info = nullptr;
+    };
+
+    template<class T>
+    TypeId TypeIdOf() {
+#if INJECTTOR_RTTI
+        // Hashed once, the hash of a std::type_info walks its name
+        static const TypeInfo info{&typeid(T), typeid(T).hash_code()};
+#else
+        static constexpr TypeInfo info{TypeName<T>::text.data(), TypeName<T>::local,
+                                       HashName(TypeName<T>::text.data())};
+#endif
+        return TypeId(&info);
+    }
+
+}
+
+template<>
+struct std::hash<DI::TypeId> {
+    std::size_t operator()(DI::TypeId type) const noexcept {
+        return type.Hash();
+    }
+};
+
+#endif //INJECTTORTEST_TYPEID_HPP
@@ -6,6 +6,7 @@
 #ifndef INJECTTORTEST_ADVANCEDEXAMPLE_H
 #define INJECTTORTEST_ADVANCEDEXAMPLE_H
 
+#include <chrono>
 #include <iostream>
 #include <string>
 #include "Container.hpp"
@@ -6,6 +6,7 @@
 #ifndef INJECTTORTEST_ADVANCEDWEBEXAMPLE_H
 #define INJECTTORTEST_ADVANCEDWEBEXAMPLE_H
 
+#include <chrono>
 #include <iostream>
 #include "Container.hpp"
 
@@ -67,6 +68,19 @@ namespace AdvancedWebExample {
         }
     };
 
+    class AuditedDatabase : public IDatabase {
+    public:
+        explicit AuditedDatabase(std::shared_ptr<IDatabase> inner) : inner(std::move(inner)) {}
+
+        void Save(const std::string &data) override {
+            std::cout << "Audit: saving " << data.size() << " bytes\n";
+            inner->Save(data);
+        }
+
+    private:
+        std::shared_ptr<IDatabase> inner;
+    };
+
     class IController {
     public:
         virtual void Action1(Request req) = 0;
@@ -76,16 +90,15 @@ namespace AdvancedWebExample {
 
     class UserController : public IController {
     public:
+        using Dependencies = DI::DependsOn<DI::Singleton<ILogger>>;
+
         UserController()
                 : logger(DI::Container::Instance().ResolveSingleton<ILogger>()) {}
 
         void Action1(Request req) override {
             logger->Log("In UserController Action1");
 
-            std::shared_ptr<IDatabase> db;
-
-            db = DI::Container::Instance().ResolveTransient<IDatabase>(req.GetActionData());
-
+            auto db = DI::Container::Instance().TryResolveTransient<IDatabase>(req.GetActionData());
             if (!db) {
                 throw std::runtime_error("Unsupported database specified");
             }
@@ -103,6 +116,8 @@ namespace AdvancedWebExample {
 
     class HomeController : public IController {
     public:
+        using Dependencies = DI::DependsOn<DI::Singleton<ILogger>>;
+
         HomeController() : logger(DI::Container::Instance().ResolveSingleton<ILogger>()) {}
 
         void Action1(Request req) override {
@@ -117,13 +132,40 @@ namespace AdvancedWebExample {
         std::shared_ptr<ILogger> logger;
     };
 
+    class IRequestHandler {
+    public:
+        virtual ~IRequestHandler() = default;
+        virtual void Handle() = 0;
+    };
+
+    class SaveUserHandler : public IRequestHandler {
+    public:
+        using Dependencies = DI::DependsOn<DI::Singleton<ILogger>>;
+
+        explicit SaveUserHandler(Request request)
+                : request(std::move(request)),
+                  logger(DI::Container::Instance().ResolveSingleton<ILogger>()) {}
+
+        void Handle() override {
+            logger->Log("In SaveUserHandler, requested: " + request.GetActionData());
+            DI::Container::Instance().ResolveTransient<IDatabase>(request.GetActionData())->Save("User data");
+        }
+
+    private:
+        Request request;
+        std::shared_ptr<ILogger> logger;
+    };
+
     void RegisterWebServerExample() {
         std::cout << "Web Example, register services\n";
         DI::Container::Instance().RegisterSingleton<ILogger, Logger>();
+        DI::Container::Instance().RegisterDecorator<IDatabase, AuditedDatabase>();
         DI::Container::Instance().RegisterTransient<IDatabase, MySQLDatabase>("MySQL");
         DI::Container::Instance().RegisterTransient<IDatabase, PostgreSQLDatabase>("PostgreSQL");
         DI::Container::Instance().RegisterTransient<IController, HomeController>("Home");
         DI::Container::Instance().RegisterTransient<IController, UserController>("User");
+        DI::Container::Instance().RegisterFactory<IRequestHandler, SaveUserHandler, Request>();
+        DI::Container::Instance().Validate();
     }
 
     void RunWebServerExample() {
@@ -145,6 +187,14 @@ namespace AdvancedWebExample {
         Request postgreRequest("PostgreSQL");
         userController->Action1(postgreRequest);
 
+        auto handler = DI::Container::Instance().Create<IRequestHandler>(Request("PostgreSQL"));
+        handler->Handle();
+
+        std::cout << "Fan-out to every registered database\n";
+        for (auto &db: DI::Container::Instance().ResolveAllTransients<IDatabase>()) {
+            db->Save("Audit data");
+        }
+
         auto end = std::chrono::high_resolution_clock::now();
 
         std::chrono::duration<double, std::milli> ms_double = end - start;
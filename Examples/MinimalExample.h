@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+//
+
+#ifndef INJECTTORTEST_MINIMALEXAMPLE_H
+#define INJECTTORTEST_MINIMALEXAMPLE_H
+
+#include <chrono>
+#include <iostream>
+#include "Container.hpp"
+
+// Built with -fno-exceptions -fno-rtti: missing services are probed with TryResolve, and errors reach the handler
+namespace MinimalExample {
+
+    class IClock {
+    public:
+        virtual ~IClock() = default;
+        virtual long long Now() = 0;
+    };
+
+    class SteadyClock : public IClock {
+    public:
+        long long Now() override {
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        }
+    };
+
+    class IOrderBook {
+    public:
+        virtual ~IOrderBook() = default;
+        virtual void Add(int quantity) = 0;
+    };
+
+    class OrderBook : public IOrderBook {
+    public:
+        using Dependencies = DI::DependsOn<DI::Singleton<IClock>>;
+
+        OrderBook() : clock(DI::Container::Instance().ResolveSingleton<IClock>()) {}
+
+        void Add(int quantity) override {
+            std::cout << "Order of " << quantity << " at " << clock->Now() << "\n";
+        }
+
+    private:
+        std::shared_ptr<IClock> clock;
+    };
+
+    void ReportError(DI::Error, const std::string &message) {
+        std::cerr << "Injection error: " << message << std::endl;
+        std::abort();
+    }
+
+    void RunMinimalExample() {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        DI::SetErrorHandler(&ReportError);
+
+        std::cout << "Minimal Example, register services\n";
+        DI::Container::Instance().RegisterSingleton<IClock, SteadyClock>();
+        DI::Container::Instance().RegisterScoped<IOrderBook, OrderBook>();
+        DI::Container::Instance().Validate();
+
+        std::cout << "Resolve dependencies\n";
+        auto scope = DI::Container::Instance().CreateScope();
+        if (auto book = DI::Container::Instance().TryResolveScoped<IOrderBook>(scope).lock()) {
+            book->Add(100);
+        }
+
+        if (!DI::Container::Instance().TryResolveTransient<IOrderBook>("Replay")) {
+            std::cout << "No replay order book registered\n";
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::milli> ms_double = end - start;
+        std::cout << "Done! Execution time: " << ms_double.count() << " ms\n-------\n";
+    }
+}
+
+#endif //INJECTTORTEST_MINIMALEXAMPLE_H
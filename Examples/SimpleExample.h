@@ -6,6 +6,7 @@
 #ifndef INJECTTORTEST_SIMPLEEXAMPLE_H
 #define INJECTTORTEST_SIMPLEEXAMPLE_H
 
+#include <chrono>
 #include <iostream>
 #include "Container.hpp"
 
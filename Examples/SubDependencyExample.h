@@ -6,6 +6,7 @@
 #ifndef INJECTTORTEST_SUBDEPENDENCYEXAMPLE_H
 #define INJECTTORTEST_SUBDEPENDENCYEXAMPLE_H
 
+#include <chrono>
 #include <iostream>
 #include "Container.hpp"
 
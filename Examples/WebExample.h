@@ -7,6 +7,7 @@
 #define INJECTTORTEST_WEBEXAMPLE_H
 
 #include "Container.hpp"
+#include <chrono>
 #include <iostream>
 #include <string>
 
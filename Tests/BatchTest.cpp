@@ -0,0 +1,204 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Commits batches while other threads register the same services one by one, and while others resolve them: each
+// service ends up registered exactly once, and the singletons of the registrations that lost are all released. A batch
+// losing a race to a single registration publishes nothing at all, at no point, whichever shards and lifetimes it spans.
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Rounds = 100;
+    constexpr int BatchSize = 16;
+
+    std::atomic<int> live{0};
+
+    struct IService {
+        virtual ~IService() = default;
+    };
+
+    struct Service : IService {
+        Service() {
+            live++;
+        }
+
+        ~Service() override {
+            live--;
+        }
+    };
+
+    struct IOther {
+        virtual ~IOther() = default;
+    };
+
+    struct Other : IOther {
+    };
+
+    struct IThird {
+        virtual ~IThird() = default;
+    };
+
+    struct Third : IThird {
+    };
+
+    // Holds the commit of its batch, once past the checks made up front, until another registration raced it
+    std::atomic<bool> constructing{false};
+    std::atomic<bool> raced{false};
+
+    struct IGate {
+        virtual ~IGate() = default;
+    };
+
+    struct Gate : IGate {
+        Gate() {
+            constructing = true;
+            while (!raced) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    bool Commit(DI::Container::Batch &batch) {
+        try {
+            batch.Commit();
+        } catch (const std::runtime_error &) {
+            return false;
+        }
+
+        return true;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    {
+        // A duplicate known up front fails the commit before anything is constructed or registered
+        DI::Container container;
+        container.RegisterSingleton<IService, Service>("taken");
+        auto batch = container.CreateBatch();
+        batch.Singleton<IService, Service>("free").Singleton<IService, Service>("taken");
+        Expect(!Commit(batch), "a duplicate fails the commit");
+        Expect(!container.TryResolveSingleton<IService>("free"), "nothing of a failed batch is registered");
+        Expect(live == 1, "nothing of a failed batch is constructed");
+
+        // Different interfaces may share a tag
+        auto shared = container.CreateBatch();
+        shared.Singleton<IService, Service>("shared").Transient<IOther, Other>("shared");
+        Expect(Commit(shared), "interfaces sharing a tag are no duplicates");
+        container.Shutdown();
+    }
+
+    Expect(live == 0, "every singleton is released");
+
+    for (int round = 0; round < Rounds; round++) {
+        DI::Container container;
+        std::atomic<bool> committed{false};
+        Tests::RunThreads(3, [&](unsigned thread) {
+            switch (thread) {
+                case 0: {
+                    auto batch = container.CreateBatch();
+                    for (int i = 0; i < BatchSize; i++) {
+                        batch.Singleton<IService, Service>(std::to_string(i));
+                    }
+
+                    Commit(batch);
+                    committed = true;
+                    break;
+                }
+                case 1:
+                    try {
+                        container.RegisterSingleton<IService, Service>(std::to_string(round % BatchSize));
+                    } catch (const std::runtime_error &) {
+                    }
+
+                    break;
+                default:
+                    while (!committed) {
+                        for (auto &service: *container.ResolveAllSingletons<IService>()) {
+                            Expect(service != nullptr, "a batch being published hands out complete singletons");
+                        }
+                    }
+
+                    break;
+            }
+        });
+
+        auto contested = container.TryResolveSingleton<IService>(std::to_string(round % BatchSize));
+        Expect(contested != nullptr, "the contested service is registered once, by the batch or by the other thread");
+
+        contested.reset();
+        container.Shutdown();
+        Expect(live == 0, "the singletons of the registrations that lost are released");
+    }
+
+    for (int round = 0; round < Rounds; round++) {
+        DI::Container container;
+        auto contested = std::to_string(round % BatchSize);
+        std::atomic<bool> committed{false};
+        bool published = true;
+        constructing = false;
+        raced = false;
+        Tests::RunThreads(3, [&](unsigned thread) {
+            switch (thread) {
+                case 0: {
+                    // Three interfaces over three lifetimes, so several shards and registries
+                    auto batch = container.CreateBatch();
+                    for (int i = 0; i < BatchSize; i++) {
+                        auto tag = std::to_string(i);
+                        batch.Singleton<IService, Service>(tag).Transient<IOther, Other>(tag).Scoped<IThird, Third>(tag);
+                    }
+
+                    batch.Singleton<IGate, Gate>();
+                    published = Commit(batch);
+                    committed = true;
+                    break;
+                }
+                case 1:
+                    // Past the checks the batch makes up front, before the ones it makes with its shards locked
+                    while (!constructing) {
+                        std::this_thread::yield();
+                    }
+
+                    container.RegisterTransient<IOther, Other>(contested);
+                    raced = true;
+                    break;
+                default:
+                    while (!committed) {
+                        for (int i = 0; i < BatchSize; i++) {
+                            auto tag = std::to_string(i);
+                            Expect(!container.TryResolveSingleton<IService>(tag), "a failed batch is never visible");
+                            Expect(tag == contested || !container.TryResolveTransient<IOther>(tag),
+                                   "a failed batch is never visible");
+                        }
+
+                        Expect(container.ResolveAllSingletons<IService>()->empty(), "a failed batch is never visible");
+                    }
+
+                    break;
+            }
+        });
+
+        Expect(!published, "a registration made while the batch commits fails the commit");
+        for (int i = 0; i < BatchSize; i++) {
+            auto tag = std::to_string(i);
+            auto scope = container.CreateScope();
+            Expect(!container.TryResolveSingleton<IService>(tag), "nothing of a failed batch is registered");
+            Expect(tag == contested || !container.TryResolveTransient<IOther>(tag),
+                   "nothing of a failed batch is registered");
+            Expect(container.TryResolveScoped<IThird>(scope, tag).expired(), "nothing of a failed batch is registered");
+        }
+
+        Expect(!container.TryResolveSingleton<IGate>(), "nothing of a failed batch is registered");
+        Expect(container.TryResolveTransient<IOther>(contested) != nullptr, "the registration that won is registered");
+        Expect(live == 0, "the singletons of a failed batch are released");
+    }
+
+    return 0;
+}
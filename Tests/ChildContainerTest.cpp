@@ -0,0 +1,86 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers services on a parent container while its children resolve them, and while another child is being created:
+// every child ends up with every registration of the parent, and the overrides of a child stay its own.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Registrations = 300;
+
+    struct IHandler {
+        virtual ~IHandler() = default;
+
+        virtual int Tenant() const = 0;
+    };
+
+    struct Handler : IHandler {
+        int Tenant() const override {
+            return 0;
+        }
+    };
+
+    struct TenantHandler : IHandler {
+        int Tenant() const override {
+            return 1;
+        }
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container parent;
+    parent.RegisterSingleton<IHandler, Handler>("shared");
+
+    auto tenant = parent.CreateChild();
+    tenant->RegisterSingleton<IHandler, TenantHandler>("shared");
+    auto other = parent.CreateChild();
+
+    std::shared_ptr<DI::Container> late;
+    std::atomic<bool> done{false};
+    Tests::RunThreads(4, [&](unsigned thread) {
+        switch (thread) {
+            case 0:
+                for (int i = 0; i < Registrations; i++) {
+                    parent.RegisterTransient<IHandler, Handler>(std::to_string(i));
+                }
+
+                done = true;
+                break;
+            case 1:
+                while (!done) {
+                    Expect(tenant->ResolveSingleton<IHandler>("shared")->Tenant() == 1,
+                           "the override of the child wins");
+                    if (auto handler = tenant->TryResolveTransient<IHandler>("0")) {
+                        Expect(handler->Tenant() == 0, "the child resolves what the parent registers");
+                    }
+                }
+
+                break;
+            case 2:
+                while (!done) {
+                    Expect(other->ResolveSingleton<IHandler>("shared")->Tenant() == 0, "other children see the parent");
+                    other->TryResolveTransient<IHandler>(std::to_string(Registrations / 2));
+                }
+
+                break;
+            default:
+                late = parent.CreateChild();
+                break;
+        }
+    });
+
+    for (auto child: {tenant.get(), other.get(), late.get()}) {
+        Expect(child->ResolveAllTransients<IHandler>().size() == Registrations, "children get every registration");
+    }
+
+    Expect(parent.ResolveSingleton<IHandler>("shared")->Tenant() == 0, "the override stays in the child");
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers services on several threads while other threads resolve them, and walk every singleton of an interface
+// through ResolveAllSingletons: readers never see a half-published registration, and the vectors they hold stay alive
+// while the registrations go on.
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Writers = 4;
+    constexpr int TagsPerWriter = 50;
+
+    struct IPlugin {
+        virtual ~IPlugin() = default;
+
+        virtual int Id() const = 0;
+    };
+
+    struct Plugin : IPlugin {
+        int Id() const override {
+            return 7;
+        }
+    };
+
+    // Types spread over the shards of the registries
+    template<int N>
+    struct IShard {
+        virtual ~IShard() = default;
+    };
+
+    template<int N>
+    struct Shard : IShard<N> {
+    };
+
+    template<int... N>
+    void RegisterShards(DI::Container &container, const std::string &tag, std::integer_sequence<int, N...>) {
+        (container.RegisterSingleton<IShard<N>, Shard<N>>(tag), ...);
+        (container.RegisterTransient<IShard<N>, Shard<N>>(tag), ...);
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    std::atomic<int> writing{Writers};
+    Tests::RunThreads(Writers * 2, [&](unsigned thread) {
+        if (thread < Writers) {
+            for (int i = 0; i < TagsPerWriter; i++) {
+                auto tag = std::to_string(thread) + "/" + std::to_string(i);
+                container.RegisterSingleton<IPlugin, Plugin>(tag);
+                RegisterShards(container, tag, std::make_integer_sequence<int, 8>());
+            }
+
+            writing--;
+            return;
+        }
+
+        while (writing > 0) {
+            auto plugins = container.ResolveAllSingletons<IPlugin>();
+            for (auto &plugin: *plugins) {
+                Expect(plugin && plugin->Id() == 7, "ResolveAllSingletons holds complete instances");
+            }
+
+            auto tag = std::to_string(thread % Writers) + "/0";
+            if (auto plugin = container.TryResolveSingleton<IPlugin>(tag)) {
+                Expect(plugin->Id() == 7, "a published singleton is complete");
+            }
+
+            container.TryResolveTransient<IShard<3>>(tag);
+        }
+    });
+
+    auto plugins = container.ResolveAllSingletons<IPlugin>();
+    Expect(plugins->size() == Writers * TagsPerWriter, "every registration made it");
+
+    // The vector handed out is not touched by the registrations made afterwards
+    container.RegisterSingleton<IPlugin, Plugin>("late");
+    Expect(plugins->size() == Writers * TagsPerWriter, "a vector handed out stays as it was");
+    Expect(container.ResolveAllSingletons<IPlugin>()->size() == Writers * TagsPerWriter + 1,
+           "a new vector holds the late registration");
+    Expect(container.ResolveSingleton<IShard<5>>("3/49") != nullptr, "registrations of every shard are found");
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves singletons and transients on several threads while another thread keeps replacing their implementation:
+// every resolve gets one implementation or the other, and the replaced descriptors are recycled rather than piling up.
+
+#include <atomic>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Replacements = 2000;
+
+    struct IValue {
+        virtual ~IValue() = default;
+
+        virtual int Value() const = 0;
+    };
+
+    struct One : IValue {
+        int Value() const override {
+            return 1;
+        }
+    };
+
+    struct Two : IValue {
+        int Value() const override {
+            return 2;
+        }
+    };
+
+    void ReplaceBoth(DI::Container &container, int round) {
+        if (round % 2) {
+            container.Replace<IValue, One>();
+            container.Replace<IValue, One>("transient");
+        } else {
+            container.Replace<IValue, Two>();
+            container.Replace<IValue, Two>("transient");
+        }
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.RegisterSingleton<IValue, One>();
+    container.RegisterTransient<IValue, One>("transient");
+
+    std::atomic<bool> done{false};
+    Tests::RunThreads(5, [&](unsigned thread) {
+        if (thread == 0) {
+            for (int round = 0; round < Replacements; round++) {
+                ReplaceBoth(container, round);
+            }
+
+            done = true;
+            return;
+        }
+
+        while (!done) {
+            auto singleton = container.ResolveSingleton<IValue>()->Value();
+            Expect(singleton == 1 || singleton == 2, "a resolve gets the old or the new singleton");
+
+            auto transient = container.ResolveTransient<IValue>("transient")->Value();
+            Expect(transient == 1 || transient == 2, "a resolve gets the old or the new transient");
+
+            // Borrowed instances may be released by the next Replace, only their presence is checked here
+            Expect(container.TryResolveSingletonRef<IValue>() != nullptr, "a borrow finds the singleton");
+        }
+    });
+
+    container.Reclaim();
+    Expect(container.Reclaim() == 0, "nothing is left to reclaim once the readers are gone");
+    Expect(container.ResolveSingleton<IValue>()->Value() == 1, "the last replacement wins");
+    Expect(container.ResolveSingletonRef<IValue>().Value() == 1, "the borrow sees the last replacement");
+
+    // Without readers, each replacement recycles the descriptor of the previous one
+    auto descriptors = container.MemoryStats().descriptors;
+    for (int round = 0; round < Replacements; round++) {
+        ReplaceBoth(container, round);
+        Expect(container.ResolveSingletonRef<IValue>().Value() == (round % 2 ? 1 : 2),
+               "a borrow after a replacement sees the new singleton");
+    }
+
+    Expect(container.MemoryStats().descriptors == descriptors, "replacing in a loop does not grow the slab");
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves constructors that resolve each other in a loop: a service depending on itself, a cycle through several
+// services, and one through tagged registrations of the same interface. Each throws a std::runtime_error naming the
+// cycle instead of overflowing the stack, and the constructions it unwinds leave nothing behind: the next resolve
+// succeeds, and the same cycle is reported the same way again.
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    DI::Container *current = nullptr;
+
+    struct ISelf {
+        virtual ~ISelf() = default;
+    };
+
+    struct Self : ISelf {
+        Self() {
+            current->ResolveTransient<ISelf>();
+        }
+    };
+
+    struct IA {
+        virtual ~IA() = default;
+    };
+
+    struct IB {
+        virtual ~IB() = default;
+    };
+
+    struct IC {
+        virtual ~IC() = default;
+    };
+
+    struct A : IA {
+        A() {
+            current->ResolveTransient<IB>();
+        }
+    };
+
+    struct B : IB {
+        B() {
+            current->ResolveTransient<IC>();
+        }
+    };
+
+    struct C : IC {
+        C() {
+            current->ResolveTransient<IA>();
+        }
+    };
+
+    struct IStage {
+        virtual ~IStage() = default;
+    };
+
+    // The first stage goes through the second, which goes back to the first
+    struct FirstStage : IStage {
+        FirstStage() {
+            current->ResolveTransient<IStage>("second");
+        }
+    };
+
+    struct SecondStage : IStage {
+        SecondStage() {
+            current->ResolveTransient<IStage>("first");
+        }
+    };
+
+    // Goes through the last stage, the end of the chain
+    struct OuterStage : IStage {
+        OuterStage() {
+            current->ResolveTransient<IStage>("last");
+        }
+    };
+
+    struct LastStage : IStage {
+    };
+
+    /**
+    * @return std::string The message of the std::runtime_error thrown by the call, empty if none was.
+    */
+    template<typename TCall>
+    std::string ErrorOf(TCall call) {
+        try {
+            call();
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+
+        return {};
+    }
+
+    std::size_t Count(const std::string &text, const std::string &part) {
+        std::size_t count = 0;
+        for (auto at = text.find(part); at != std::string::npos; at = text.find(part, at + part.size())) {
+            count++;
+        }
+
+        return count;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    current = &container;
+    container.RegisterTransient<ISelf, Self>();
+    container.RegisterTransient<IA, A>();
+    container.RegisterTransient<IB, B>();
+    container.RegisterTransient<IC, C>();
+    container.RegisterTransient<IStage, FirstStage>("first");
+    container.RegisterTransient<IStage, SecondStage>("second");
+    container.RegisterTransient<IStage, OuterStage>("outer");
+    container.RegisterTransient<IStage, LastStage>("last");
+
+    auto direct = ErrorOf([&] { container.ResolveTransient<ISelf>(); });
+    Expect(direct.find("Dependency cycle") != std::string::npos, "a service depending on itself is a cycle");
+    Expect(Count(direct, " -> ") == 1, "the cycle of a service depending on itself is Self -> Self");
+
+    auto indirect = ErrorOf([&] { container.ResolveTransient<IB>(); });
+    Expect(indirect.find("Dependency cycle") != std::string::npos, "a cycle through several services is detected");
+    Expect(Count(indirect, " -> ") == 3, "the cycle names every service on it, B -> C -> A -> B");
+
+    auto tagged = ErrorOf([&] { container.ResolveTransient<IStage>("first"); });
+    Expect(tagged.find("Dependency cycle") != std::string::npos, "a cycle through tagged registrations is detected");
+    Expect(tagged.find("FirstStage") != std::string::npos && tagged.find("SecondStage") != std::string::npos,
+           "the cycle names the implementations of the tags");
+
+    // The frames are unwound along with the exception
+    Expect(container.ResolveTransient<IStage>("outer") != nullptr, "a resolve after a cycle succeeds");
+    Expect(container.ResolveTransient<IStage>("last") != nullptr, "a resolve after a cycle succeeds");
+    Expect(ErrorOf([&] { container.ResolveTransient<IB>(); }) == indirect, "a cycle is reported the same way again");
+    Expect(ErrorOf([&] { container.ResolveTransient<IA>(); }).find("Dependency cycle") != std::string::npos,
+           "a cycle is detected from any of its services");
+
+    current = nullptr;
+    return 0;
+}
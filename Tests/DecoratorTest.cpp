@@ -0,0 +1,115 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers decorators while other threads resolve the decorated services: a resolve gets the service with some prefix
+// of the chain applied, and once the decorators are registered every lifetime gets the whole chain, in order. A child
+// decorating what it inherited keeps its decorated registrations when the parent replaces them, a child that did not
+// follows the parent.
+
+#include <atomic>
+#include <memory>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    struct IValue {
+        virtual ~IValue() = default;
+
+        virtual int Value() const = 0;
+    };
+
+    struct One : IValue {
+        int Value() const override {
+            return 1;
+        }
+    };
+
+    struct Double : IValue {
+        explicit Double(std::shared_ptr<IValue> inner) : inner(std::move(inner)) {}
+
+        int Value() const override {
+            return inner->Value() * 2;
+        }
+
+        std::shared_ptr<IValue> inner;
+    };
+
+    struct Ten : IValue {
+        int Value() const override {
+            return 10;
+        }
+    };
+
+    struct AddOne : IValue {
+        explicit AddOne(std::shared_ptr<IValue> inner) : inner(std::move(inner)) {}
+
+        int Value() const override {
+            return inner->Value() + 1;
+        }
+
+        std::shared_ptr<IValue> inner;
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.RegisterSingleton<IValue, One>();
+    container.RegisterTransient<IValue, One>();
+    container.RegisterThreadLocal<IValue, One>();
+
+    // 1, then Double(1) = 2, then AddOne(Double(1)) = 3: the last decorator registered is the outermost
+    std::atomic<bool> done{false};
+    Tests::RunThreads(4, [&](unsigned thread) {
+        if (thread == 0) {
+            container.RegisterDecorator<IValue, Double>();
+            container.RegisterDecorator<IValue, AddOne>();
+            done = true;
+            return;
+        }
+
+        while (!done) {
+            auto singleton = container.ResolveSingleton<IValue>()->Value();
+            Expect(singleton >= 1 && singleton <= 3, "a singleton resolved meanwhile is decorated or not");
+
+            auto transient = container.ResolveTransient<IValue>()->Value();
+            Expect(transient >= 1 && transient <= 3, "a transient resolved meanwhile is decorated or not");
+        }
+    });
+
+    Expect(container.ResolveSingleton<IValue>()->Value() == 3, "the singleton gets the whole chain");
+    Expect(container.ResolveSingleton<IValue>() == container.ResolveSingleton<IValue>(), "it is wrapped once");
+    Expect(container.ResolveTransient<IValue>()->Value() == 3, "transients get the whole chain");
+    Expect(container.ResolveThreadLocal<IValue>()->Value() == 3, "thread-local services get the whole chain");
+
+    // Registrations made afterwards are decorated as they are registered
+    container.RegisterScoped<IValue, One>();
+    auto scope = container.CreateScope();
+    Expect(container.ResolveScoped<IValue>(scope).lock()->Value() == 3, "later registrations get the whole chain");
+
+    // Decorating inherited registrations makes them the child's own, cut from the parent
+    DI::Container parent;
+    parent.RegisterSingleton<IValue, One>();
+    parent.RegisterTransient<IValue, One>();
+    auto decorating = parent.CreateChild();
+    auto following = parent.CreateChild();
+    decorating->RegisterDecorator<IValue, Double>();
+    Expect(decorating->ResolveSingleton<IValue>()->Value() == 2, "a child decorates the singleton it inherited");
+    Expect(decorating->ResolveTransient<IValue>()->Value() == 2, "a child decorates the transient it inherited");
+    Expect(parent.ResolveSingleton<IValue>()->Value() == 1, "the decorators of a child leave its parent alone");
+
+    parent.Replace<IValue, Ten>();
+    Expect(parent.ResolveSingleton<IValue>()->Value() == 10, "the parent gets its replacement");
+    Expect(following->ResolveSingleton<IValue>()->Value() == 10, "a child that did not decorate follows its parent");
+    Expect(following->ResolveTransient<IValue>()->Value() == 10, "a child that did not decorate follows its parent");
+    Expect(decorating->ResolveSingleton<IValue>()->Value() == 2, "a decorated singleton no longer follows the parent");
+    Expect(decorating->ResolveTransient<IValue>()->Value() == 2, "a decorated transient no longer follows the parent");
+
+    // Until the child replaces them itself, decorators included
+    decorating->Replace<IValue, Ten>();
+    Expect(decorating->ResolveSingleton<IValue>()->Value() == 20, "the child decorates its own replacement");
+    Expect(decorating->ResolveTransient<IValue>()->Value() == 20, "the child decorates its own replacement");
+    return 0;
+}
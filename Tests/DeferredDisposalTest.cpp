@@ -0,0 +1,67 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Creates scopes with deferred disposal on several threads of a fresh container at once, the first of them racing to
+// use its disposal queue: every instance is destroyed exactly once, off the threads that ended the scopes.
+
+#include <atomic>
+#include <thread>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr unsigned Threads = 8;
+    constexpr int ScopesPerThread = 200;
+
+    std::atomic<int> created{0};
+    std::atomic<int> destroyed{0};
+    std::atomic<int> destroyedInline{0};
+
+    thread_local bool endingScopes = false;
+
+    struct IUnitOfWork {
+        virtual ~IUnitOfWork() = default;
+    };
+
+    struct UnitOfWork : IUnitOfWork {
+        UnitOfWork() {
+            created++;
+        }
+
+        ~UnitOfWork() override {
+            destroyed++;
+            if (endingScopes) {
+                destroyedInline++;
+            }
+        }
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    for (int round = 0; round < 20; round++) {
+        DI::Container container;
+        container.RegisterScoped<IUnitOfWork, UnitOfWork>();
+
+        Tests::RunThreads(Threads, [&](unsigned thread) {
+            endingScopes = true;
+            if (thread == 0) {
+                container.SetDisposalCapacity(Threads * ScopesPerThread);
+            }
+
+            for (int i = 0; i < ScopesPerThread; i++) {
+                auto scope = container.CreateScope(DI::Disposal::Deferred);
+                container.ResolveScoped<IUnitOfWork>(scope);
+            }
+        });
+
+        container.FlushDisposals();
+        Expect(destroyed == created, "every deferred instance is destroyed");
+    }
+
+    // The capacity is large enough for every instance, none had to be destroyed by the thread ending its scope
+    Expect(destroyedInline == 0, "deferred instances are destroyed off the threads ending the scopes");
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Creates services through factories taking runtime arguments: rvalues are moved to the constructor and lvalues
+// copied once, string literals and character pointers reach factories registered with std::string, tags pick the
+// factory, decorators wrap what is created, and arguments no factory takes are reported as such.
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    /**
+    * @brief Counts the copies made of it.
+    */
+    struct Payload {
+        explicit Payload(int *copies) : copies(copies) {}
+
+        Payload(const Payload &other) : copies(other.copies) {
+            (*copies)++;
+        }
+
+        Payload(Payload &&other) noexcept = default;
+
+        int *copies;
+    };
+
+    struct IGreeter {
+        virtual ~IGreeter() = default;
+
+        virtual std::string Greet() const = 0;
+    };
+
+    struct Greeter : IGreeter {
+        explicit Greeter(std::string name) : name(std::move(name)) {}
+
+        std::string Greet() const override {
+            return "Hello " + name;
+        }
+
+        std::string name;
+    };
+
+    struct FormalGreeter : IGreeter {
+        explicit FormalGreeter(std::string name) : name(std::move(name)) {}
+
+        std::string Greet() const override {
+            return "Good day " + name;
+        }
+
+        std::string name;
+    };
+
+    struct LoudGreeter : IGreeter {
+        explicit LoudGreeter(std::shared_ptr<IGreeter> inner) : inner(std::move(inner)) {}
+
+        std::string Greet() const override {
+            return inner->Greet() + "!";
+        }
+
+        std::shared_ptr<IGreeter> inner;
+    };
+
+    struct IJob {
+        virtual ~IJob() = default;
+    };
+
+    struct Job : IJob {
+        Job(std::unique_ptr<int> id, Payload payload, std::reference_wrapper<int> runs)
+                : id(std::move(id)), payload(std::move(payload)) {
+            runs.get()++;
+        }
+
+        std::unique_ptr<int> id;
+        Payload payload;
+    };
+
+    bool Throws(const std::function<void()> &call, const std::string &message) {
+        try {
+            call();
+        } catch (const std::runtime_error &error) {
+            return std::string(error.what()).find(message) != std::string::npos;
+        }
+
+        return false;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.RegisterFactory<IJob, Job, std::unique_ptr<int>, Payload, std::reference_wrapper<int>>();
+
+    // Rvalues are moved, lvalues copied once, references go through std::ref
+    int copies = 0;
+    int runs = 0;
+    Payload payload(&copies);
+    auto created = container.Create<IJob>(std::make_unique<int>(7), payload, std::ref(runs));
+    auto job = std::static_pointer_cast<Job>(created);
+    Expect(*job->id == 7, "a move-only argument is moved to the constructor");
+    Expect(copies == 1, "an lvalue argument is copied once");
+    Expect(runs == 1, "a reference argument reaches the constructor");
+
+    container.Create<IJob>(std::make_unique<int>(8), Payload(&copies), std::ref(runs));
+    Expect(copies == 1, "an rvalue argument is never copied");
+    Expect(runs == 2, "a reference argument reaches the constructor");
+
+    // Text reaches factories taking std::string whatever it is given as
+    container.RegisterFactory<IGreeter, Greeter, std::string>();
+    Expect(container.Create<IGreeter>("Ada")->Greet() == "Hello Ada", "a string literal is passed as std::string");
+
+    char name[] = "Grace";
+    char *pointer = name;
+    const char *constant = name;
+    Expect(container.Create<IGreeter>(pointer)->Greet() == "Hello Grace", "a char pointer is passed as std::string");
+    Expect(container.Create<IGreeter>(constant)->Greet() == "Hello Grace",
+           "a const char pointer is passed as std::string");
+    Expect(container.Create<IGreeter>(name)->Greet() == "Hello Grace", "a char array is passed as std::string");
+
+    std::string text = "Alan";
+    Expect(container.Create<IGreeter>(text)->Greet() == "Hello Alan", "a std::string lvalue is copied");
+    Expect(text == "Alan", "a std::string lvalue is left as it was");
+
+    // Tags pick the factory, duplicates are rejected
+    container.RegisterFactory<IGreeter, FormalGreeter, std::string>("formal");
+    Expect(container.CreateTagged<IGreeter>("formal", "Ada")->Greet() == "Good day Ada", "the tag picks the factory");
+    Expect(container.Create<IGreeter>("Ada")->Greet() == "Hello Ada", "the untagged factory is still the default");
+    Expect(Throws([&] { container.RegisterFactory<IGreeter, FormalGreeter, std::string>("formal"); },
+                  "Factory already registered"), "a factory is registered once per tag");
+    Expect(Throws([&] { container.CreateTagged<IGreeter>("casual", "Ada"); }, "Factory not found"),
+           "an unknown tag is reported");
+
+    // Arguments no factory takes are reported
+    Expect(Throws([&] { container.Create<IGreeter>(42); }, "Factory not found"),
+           "arguments no factory takes are reported");
+    Expect(Throws([&] { container.Create<IGreeter>(); }, "Factory not found"),
+           "missing arguments are reported");
+    Expect(Throws([&] { container.Create<IGreeter>("Ada", "Grace"); }, "Factory not found"),
+           "extra arguments are reported");
+
+    // Decorators registered beforehand wrap what factories create
+    container.RegisterDecorator<IGreeter, LoudGreeter>();
+    container.RegisterFactory<IGreeter, Greeter, std::string>("loud");
+    Expect(container.CreateTagged<IGreeter>("loud", "Ada")->Greet() == "Hello Ada!",
+           "a decorator wraps what a factory registered afterwards creates");
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Recycles the instances of a reusable scoped service across scopes, ended on the calling threads and on the disposal
+// thread: a scope gets back an instance reset by Reset(), and no instance is ever held by two scopes at once.
+
+#include <atomic>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr unsigned Threads = 6;
+    constexpr int ScopesPerThread = 500;
+
+    std::atomic<int> resets{0};
+
+    struct IUnitOfWork {
+        virtual ~IUnitOfWork() = default;
+
+        virtual void Track() = 0;
+
+        virtual int Tracked() const = 0;
+    };
+
+    struct UnitOfWork : IUnitOfWork {
+        void Track() override {
+            // Any other scope holding the instance at the same time would see a count above one
+            Tests::Expect(++tracked == 1, "an instance is held by a single scope at a time");
+        }
+
+        int Tracked() const override {
+            return tracked;
+        }
+
+        void Reset() {
+            tracked = 0;
+            resets++;
+        }
+
+        std::atomic<int> tracked{0};
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.RegisterScopedReusable<IUnitOfWork, UnitOfWork>("", Threads, DI::Disposal::Inline);
+
+    // On a single thread, the second scope gets the instance of the first one, reset
+    IUnitOfWork *first;
+    {
+        auto scope = container.CreateScope();
+        auto unit = container.ResolveScoped<IUnitOfWork>(scope).lock();
+        unit->Track();
+        first = unit.get();
+    }
+
+    {
+        auto scope = container.CreateScope();
+        auto unit = container.ResolveScoped<IUnitOfWork>(scope).lock();
+        Expect(unit.get() == first, "the next scope reuses the released instance");
+        Expect(unit->Tracked() == 0, "a reused instance was reset");
+    }
+
+    Expect(resets == 2, "every released instance is reset");
+
+    // Scopes on several threads, ended inline or on the disposal thread
+    Tests::RunThreads(Threads, [&](unsigned thread) {
+        auto disposal = thread % 2 ? DI::Disposal::Deferred : DI::Disposal::Inline;
+        for (int i = 0; i < ScopesPerThread; i++) {
+            auto scope = container.CreateScope(disposal);
+            container.ResolveScoped<IUnitOfWork>(scope).lock()->Track();
+        }
+    });
+
+    container.FlushDisposals();
+
+    auto stats = container.ScopedPoolStats<IUnitOfWork>();
+    Expect(stats.inUse == 0, "every instance is back in the pool");
+    Expect(stats.constructed + stats.reused == Threads * ScopesPerThread + 2, "every scope got an instance");
+    Expect(stats.reused > stats.constructed, "most scopes reuse an instance");
+    Expect(resets == static_cast<int>(Threads * ScopesPerThread + 2), "every released instance is reset");
+    return 0;
+}
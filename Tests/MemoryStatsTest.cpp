@@ -0,0 +1,182 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Registers services of known sizes and checks what each MemoryStats category reports for them: long tags in the
+// registry and in the singleton tables, decorator chains, per-node replicas, idle pooled instances and singleton
+// dependencies as bookkeeping. Every byte the container takes from its memory resource is reported, and given back.
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr std::size_t TagLength = 4096;
+    constexpr std::size_t Decorators = 64;
+    constexpr std::size_t Nodes = 8;
+    constexpr std::size_t PoolSize = 256;
+    constexpr std::size_t Resolves = 100;
+
+    /**
+    * @brief Counts the bytes currently allocated from it.
+    */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes = 0;
+
+    private:
+        void *do_allocate(std::size_t size, std::size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+
+        void do_deallocate(void *pointer, std::size_t size, std::size_t alignment) override {
+            bytes -= size;
+            std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    struct IService {
+        virtual ~IService() = default;
+    };
+
+    struct Service : IService {
+        char payload[100];
+    };
+
+    struct Decorator : IService {
+        explicit Decorator(std::shared_ptr<IService> inner) : inner(std::move(inner)) {}
+
+        std::shared_ptr<IService> inner;
+    };
+
+    struct IReplica {
+        virtual ~IReplica() = default;
+    };
+
+    struct Replica : IReplica {
+        char payload[200];
+    };
+
+    struct IPooled {
+        virtual ~IPooled() = default;
+    };
+
+    struct Pooled : IPooled {
+        void Reset() {}
+
+        char payload[300];
+    };
+
+    struct IDependency {
+        virtual ~IDependency() = default;
+    };
+
+    struct Dependency : IDependency {
+    };
+
+    struct IConsumer {
+        virtual ~IConsumer() = default;
+    };
+
+    DI::Container *current = nullptr;
+
+    // Resolves its dependency over and over, each resolve is recorded
+    struct Consumer : IConsumer {
+        Consumer() {
+            for (std::size_t i = 0; i < Resolves; i++) {
+                current->ResolveSingleton<IDependency>();
+            }
+        }
+    };
+
+    void ExpectReported(DI::Container &container, const CountingResource &resource) {
+        Tests::Expect(container.MemoryStats().Overhead() == resource.bytes,
+                      "every byte taken from the resource is reported");
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::NumaTopology::Simulate({0, 1, 2, 3, 4, 5, 6, 7});
+    CountingResource resource;
+    {
+        DI::Container container(&resource);
+        current = &container;
+        std::string tag(TagLength, 't');
+
+        // Tags longer than the small string buffer are charged to the registry, and to the singleton tables
+        auto before = container.MemoryStats();
+        container.RegisterTransient<IService, Service>(tag);
+        auto after = container.MemoryStats();
+        Expect(after.registry - before.registry >= TagLength, "the tag of a transient is counted as registry");
+        ExpectReported(container, resource);
+
+        before = after;
+        container.RegisterSingleton<IService, Service>(tag);
+        after = container.MemoryStats();
+        Expect(after.registry - before.registry >= TagLength, "the tag of a singleton is counted as registry");
+        Expect(after.singletonTable - before.singletonTable >= TagLength,
+               "the tag of a singleton is counted in its singleton table");
+        Expect(after.instances - before.instances == sizeof(Service), "a singleton is counted by its size");
+        ExpectReported(container, resource);
+
+        // Both the chain of the interface and the chain of each decorated registration
+        before = after;
+        for (std::size_t i = 0; i < Decorators; i++) {
+            container.RegisterDecorator<IService, Decorator>();
+        }
+
+        container.Reclaim();
+        after = container.MemoryStats();
+        Expect(after.bookkeeping - before.bookkeeping >= 3 * Decorators * sizeof(DI::ErasedFnc),
+               "decorator chains are counted as bookkeeping");
+        ExpectReported(container, resource);
+
+        before = after;
+        container.RegisterSingletonPerNode<IReplica, Replica>();
+        after = container.MemoryStats();
+        Expect(after.bookkeeping - before.bookkeeping >= Nodes * sizeof(std::shared_ptr<void>),
+               "replica sets are counted as bookkeeping");
+        Expect(after.instances - before.instances == Nodes * sizeof(Replica), "every replica is counted by its size");
+        ExpectReported(container, resource);
+
+        container.RegisterScopedReusable<IPooled, Pooled>("", PoolSize);
+        before = container.MemoryStats();
+        container.ReserveScopedPool<IPooled>(PoolSize);
+        after = container.MemoryStats();
+        Expect(after.bookkeeping - before.bookkeeping >= PoolSize * sizeof(void *),
+               "the idle instances of a pool are listed as bookkeeping");
+        Expect(after.instances - before.instances == PoolSize * sizeof(Pooled),
+               "idle pooled instances are counted by their size");
+        ExpectReported(container, resource);
+
+        container.RegisterSingleton<IDependency, Dependency>();
+        before = container.MemoryStats();
+        container.RegisterSingleton<IConsumer, Consumer>();
+        after = container.MemoryStats();
+        Expect(after.bookkeeping - before.bookkeeping >= Resolves * sizeof(void *),
+               "singleton dependencies are counted as bookkeeping");
+        ExpectReported(container, resource);
+
+        // A child charges its own entries, tags included, to itself
+        auto child = container.CreateChild();
+        Expect(child->MemoryStats().registry >= 2 * TagLength, "a child counts the tags of its own entries");
+        Expect(child->MemoryStats().singletonTable >= TagLength, "a child counts the tags of its singleton tables");
+        child.reset();
+        ExpectReported(container, resource);
+
+        container.Shutdown();
+        current = nullptr;
+    }
+
+    Expect(resource.bytes == 0, "everything taken from the resource is given back");
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Built with -fno-exceptions -fno-rtti: types are told apart by their TypeInfo constants, missing services are probed
+// with TryResolve, and errors reach the installed handler, which ends the test.
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+#if INJECTTOR_EXCEPTIONS || INJECTTOR_RTTI
+#error "NoExceptionsTest must be built with -fno-exceptions -fno-rtti"
+#endif
+
+namespace {
+
+    struct IClock {
+        virtual ~IClock() = default;
+
+        virtual int Now() const = 0;
+    };
+
+    struct Clock : IClock {
+        int Now() const override {
+            return 42;
+        }
+    };
+
+    // Same layout and same tag as IClock, a different type all the same
+    struct IOtherClock {
+        virtual ~IOtherClock() = default;
+
+        virtual int Now() const = 0;
+    };
+
+    struct OtherClock : IOtherClock {
+        int Now() const override {
+            return 7;
+        }
+    };
+
+    struct IMissing {
+        virtual ~IMissing() = default;
+    };
+
+    // Errors do not return: the expected one ends the test successfully, any other one fails it
+    void ExpectNotFound(DI::Error error, const std::string &message) {
+        Tests::Expect(error == DI::Error::NotFound, "the error reports a missing service");
+        Tests::Expect(message.find("IMissing") != std::string::npos, "the message names the missing interface");
+        std::exit(EXIT_SUCCESS);
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    Expect(DI::TypeIdOf<IClock>() != DI::TypeIdOf<IOtherClock>(), "types have distinct identities without RTTI");
+    Expect(std::strstr(DI::TypeIdOf<IClock>()->name(), "IClock") != nullptr, "types are named without RTTI");
+
+    DI::Container container;
+    container.CreateBatch().Singleton<IClock, Clock>("wall").Singleton<IOtherClock, OtherClock>("wall").Commit();
+    Expect(container.ResolveSingleton<IClock>("wall")->Now() == 42, "the first type resolves its implementation");
+    Expect(container.ResolveSingleton<IOtherClock>("wall")->Now() == 7, "the second type resolves its implementation");
+
+    Expect(!container.TryResolveSingleton<IMissing>(), "TryResolve reports a missing service without an error");
+    Expect(!container.TryResolveTransient<IMissing>(), "TryResolve reports a missing transient without an error");
+
+    DI::SetErrorHandler(&ExpectNotFound);
+    container.ResolveSingleton<IMissing>();
+
+    Expect(false, "the handler ends the test before the resolve returns");
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Simulates a machine of three NUMA nodes and resolves a per-node singleton from threads assigned to each of them:
+// threads of the same node share a replica, threads of different nodes never do, whether they resolve or borrow it.
+// Each replica, decorated or not, is constructed on a thread of its node and shares no cache line with another one.
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr std::size_t Nodes = 3;
+    constexpr unsigned ThreadsPerNode = 4;
+
+    struct IConfig {
+        virtual ~IConfig() = default;
+    };
+
+    // Where the replica was constructed
+    struct Config : IConfig {
+        std::size_t node = DI::NumaTopology::CurrentNode();
+        std::thread::id thread = std::this_thread::get_id();
+    };
+
+    struct Decorator : IConfig {
+        explicit Decorator(std::shared_ptr<IConfig> inner) : inner(std::move(inner)) {}
+
+        std::shared_ptr<IConfig> inner;
+        std::size_t node = DI::NumaTopology::CurrentNode();
+    };
+
+    /**
+    * @return bool Whether the objects share no cache line, each of them taken with its size.
+    */
+    template<typename T>
+    bool Apart(const std::array<T *, Nodes> &objects) {
+        constexpr auto line = DI::ReplicaResource::CacheLine;
+        for (std::size_t i = 0; i < Nodes; i++) {
+            for (std::size_t j = 0; j < Nodes; j++) {
+                auto first = reinterpret_cast<std::uintptr_t>(objects[i]);
+                auto second = reinterpret_cast<std::uintptr_t>(objects[j]);
+                if (i != j && first / line <= (second + sizeof(T) - 1) / line &&
+                    second / line <= (first + sizeof(T) - 1) / line) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    // Two CPUs per node, to be simulated before anything is registered per node
+    DI::NumaTopology::Simulate({0, 0, 1, 1, 2, 2});
+    Expect(DI::NumaTopology::NodeCount() == Nodes, "the simulated topology is in effect");
+
+    DI::Container container;
+    container.RegisterSingletonPerNode<IConfig, Config>();
+
+    std::mutex lock;
+    std::array<std::set<IConfig *>, Nodes> replicas;
+    Tests::RunThreads(Nodes * ThreadsPerNode, [&](unsigned thread) {
+        auto node = thread % Nodes;
+        DI::NumaTopology::AssignThread(node);
+
+        auto resolved = container.ResolveSingleton<IConfig>();
+        for (int i = 0; i < 100; i++) {
+            Expect(container.ResolveSingleton<IConfig>() == resolved, "a thread keeps getting the same replica");
+            Expect(&container.ResolveSingletonRef<IConfig>() == resolved.get(), "a borrow lends the same replica");
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        replicas[node].insert(resolved.get());
+    });
+
+    std::set<IConfig *> all;
+    for (auto &node: replicas) {
+        Expect(node.size() == 1, "the threads of a node share its replica");
+        all.insert(*node.begin());
+    }
+
+    Expect(all.size() == Nodes, "each node has a replica of its own");
+
+    // A thread moving to another node gets the replica of that node, borrowed ones included
+    DI::NumaTopology::AssignThread(0);
+    auto &first = container.ResolveSingletonRef<IConfig>();
+    DI::NumaTopology::AssignThread(2);
+    Expect(&container.ResolveSingletonRef<IConfig>() == *replicas[2].begin(),
+           "a borrow follows the node of the thread");
+    Expect(&first == *replicas[0].begin(), "a borrow on node 0 lends the replica of node 0");
+
+    std::array<Config *, Nodes> configs{};
+    for (std::size_t node = 0; node < Nodes; node++) {
+        configs[node] = static_cast<Config *>(*replicas[node].begin());
+        Expect(configs[node]->node == node, "each replica is constructed on its node");
+        Expect(configs[node]->thread != std::this_thread::get_id(), "replicas are constructed on threads of their own");
+    }
+
+    Expect(Apart(configs), "replicas share no cache line");
+
+    // Decorators wrap each replica on its node, on cache lines of their own as well
+    container.RegisterDecorator<IConfig, Decorator>();
+    std::array<Decorator *, Nodes> decorators{};
+    for (std::size_t node = 0; node < Nodes; node++) {
+        DI::NumaTopology::AssignThread(node);
+        decorators[node] = static_cast<Decorator *>(container.ResolveSingleton<IConfig>().get());
+        Expect(decorators[node]->inner.get() == configs[node], "a decorator wraps the replica of its node");
+        Expect(decorators[node]->node == node, "each decorator is constructed on its node");
+    }
+
+    Expect(Apart(decorators), "decorated replicas share no cache line");
+    return 0;
+}
@@ -0,0 +1,18 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#include "PluginGreeter.hpp"
+
+namespace {
+
+    struct Greeter : IGreeter {
+        std::string Greet() const override {
+            return "hello from the plugin";
+        }
+    };
+
+}
+
+void RegisterGreeters(DI::Container &container) {
+    container.RegisterSingleton<IGreeter, Greeter>();
+    container.RegisterTransient<IGreeter, Greeter>("transient");
+}
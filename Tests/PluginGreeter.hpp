@@ -0,0 +1,32 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_PLUGINGREETER_HPP
+#define INJECTTORTEST_PLUGINGREETER_HPP
+
+#include <string>
+#include "Container.hpp"
+
+#if defined(_WIN32) && defined(PLUGIN_GREETER_BUILD)
+#define PLUGIN_GREETER_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define PLUGIN_GREETER_API __declspec(dllimport)
+#else
+#define PLUGIN_GREETER_API __attribute__((visibility("default")))
+#endif
+
+/*
+* The interface shared by PluginTest and the plugin it loads. Every symbol of the plugin but RegisterGreeters is
+* hidden, so the type_info of IGreeter and the TypeInfo of the container are not the ones of the host.
+*/
+struct IGreeter {
+    virtual ~IGreeter() = default;
+
+    virtual std::string Greet() const = 0;
+};
+
+/**
+* @brief Registers the greeters of the plugin in the container of the host.
+*/
+PLUGIN_GREETER_API void RegisterGreeters(DI::Container &container);
+
+#endif //INJECTTORTEST_PLUGINGREETER_HPP
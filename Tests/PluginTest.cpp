@@ -0,0 +1,24 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves, from the host, services a shared library built with -fvisibility=hidden registered: the library holds
+// type_info and TypeInfo objects of its own for the interface, which must not keep the host from finding them.
+
+#include "PluginGreeter.hpp"
+#include "TestSupport.hpp"
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    RegisterGreeters(container);
+
+    auto greeter = container.TryResolveSingleton<IGreeter>();
+    Expect(greeter && greeter->Greet() == "hello from the plugin", "a singleton of the plugin resolves from the host");
+
+    auto transient = container.TryResolveTransient<IGreeter>("transient");
+    Expect(transient && transient != greeter, "a transient service of the plugin resolves from the host");
+
+    container.EnableThreadCache();
+    Expect(container.TryResolveTransient<IGreeter>("transient") != nullptr, "the thread cache finds it as well");
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves every implementation of an interface, registered over several chunks of a group in an order unrelated to
+// their tags: ResolveAllScoped, ResolveAllTransients and ResolveAllSingletons all keep the registration order, and so
+// do replaced registrations and children. Scoped instances are created once per scope, handed out again by the same
+// scope, distinct in another one, and released along with their scope.
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    // Spans several chunks of the group, and is coprime with the stride
+    constexpr std::size_t Count = 40;
+    constexpr std::size_t Stride = 17;
+    constexpr std::size_t Replaced = 5;
+
+    struct IService {
+        virtual ~IService() = default;
+
+        virtual std::size_t Number() const = 0;
+    };
+
+    template<std::size_t N>
+    struct Numbered : IService {
+        std::size_t Number() const override {
+            return N;
+        }
+    };
+
+    struct Replacement : IService {
+        std::size_t Number() const override {
+            return Count;
+        }
+    };
+
+    /**
+    * @return std::size_t The number registered in the given position.
+    */
+    constexpr std::size_t NumberAt(std::size_t position) {
+        return position * Stride % Count;
+    }
+
+    template<std::size_t... Positions>
+    void RegisterAll(DI::Container &container, std::index_sequence<Positions...>) {
+        (container.RegisterScoped<IService, Numbered<NumberAt(Positions)>>(std::to_string(NumberAt(Positions))), ...);
+        (container.RegisterTransient<IService, Numbered<NumberAt(Positions)>>(std::to_string(NumberAt(Positions))),
+                ...);
+        (container.RegisterSingleton<IService, Numbered<NumberAt(Positions)>>(std::to_string(NumberAt(Positions))),
+                ...);
+    }
+
+    std::vector<std::size_t> Expected(std::size_t replaced = Count) {
+        std::vector<std::size_t> numbers;
+        for (std::size_t position = 0; position < Count; position++) {
+            numbers.push_back(position == replaced ? Count : NumberAt(position));
+        }
+
+        return numbers;
+    }
+
+    template<typename TInstances>
+    std::vector<std::size_t> Numbers(const TInstances &instances) {
+        std::vector<std::size_t> numbers;
+        for (auto &instance: instances) {
+            if constexpr (requires { instance.lock(); }) {
+                numbers.push_back(instance.lock()->Number());
+            } else {
+                numbers.push_back(instance->Number());
+            }
+        }
+
+        return numbers;
+    }
+
+    template<typename TInstance>
+    std::vector<const IService *> Addresses(const std::vector<TInstance> &instances) {
+        std::vector<const IService *> addresses;
+        for (auto &instance: instances) {
+            addresses.push_back(instance.lock().get());
+        }
+
+        return addresses;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    RegisterAll(container, std::make_index_sequence<Count>());
+
+    // Scoped instances, once per scope
+    auto scope = container.CreateScope();
+    auto first = container.ResolveAllScoped<IService>(scope);
+    Expect(Numbers(first) == Expected(), "ResolveAllScoped keeps the registration order");
+    Expect(Addresses(container.ResolveAllScoped<IService>(scope)) == Addresses(first),
+           "a scope hands out the same instances again");
+
+    auto other = container.CreateScope();
+    auto second = container.ResolveAllScoped<IService>(other);
+    Expect(Numbers(second) == Expected(), "ResolveAllScoped keeps the registration order in every scope");
+    for (std::size_t i = 0; i < Count; i++) {
+        Expect(first[i].lock() != second[i].lock(), "each scope has instances of its own");
+    }
+
+    scope.reset();
+    for (auto &instance: first) {
+        Expect(instance.expired(), "scoped instances are released along with their scope");
+    }
+
+    Expect(!second.front().expired(), "the instances of another scope live on");
+
+    // Transients are new every time, singletons the same
+    auto transients = container.ResolveAllTransients<IService>();
+    Expect(Numbers(transients) == Expected(), "ResolveAllTransients keeps the registration order");
+    Expect(container.ResolveAllTransients<IService>().front() != transients.front(), "transients are new every time");
+
+    auto singletons = container.ResolveAllSingletons<IService>();
+    Expect(Numbers(*singletons) == Expected(), "ResolveAllSingletons keeps the registration order");
+    Expect(container.ResolveAllSingletons<IService>()->front() == singletons->front(),
+           "singletons are the same every time");
+
+    // A replaced registration keeps its position
+    auto tag = std::to_string(NumberAt(Replaced));
+    container.Replace<IService, Replacement>(tag);
+    auto replacedScope = container.CreateScope();
+    Expect(Numbers(container.ResolveAllScoped<IService>(replacedScope)) == Expected(Replaced),
+           "a replaced scoped registration keeps its position");
+    Expect(Numbers(container.ResolveAllTransients<IService>()) == Expected(Replaced),
+           "a replaced transient registration keeps its position");
+    Expect(Numbers(*container.ResolveAllSingletons<IService>()) == Expected(Replaced),
+           "a replaced singleton keeps its position");
+    Expect(Numbers(container.ResolveAllScoped<IService>(other)) == Expected(),
+           "a scope keeps the instances it resolved before the replacement");
+
+    // A child lists the inherited registrations first, its own after them
+    auto child = container.CreateChild();
+    child->RegisterTransient<IService, Numbered<Count + 1>>("child");
+    auto expected = Expected(Replaced);
+    expected.push_back(Count + 1);
+    Expect(Numbers(child->ResolveAllTransients<IService>()) == expected,
+           "a child keeps the inherited order and appends its own registrations");
+
+    return 0;
+}
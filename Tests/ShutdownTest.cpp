@@ -0,0 +1,193 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Shuts down a diamond of singletons, serially and in parallel: each singleton is destroyed before the singletons it
+// depends on, its destructor can still resolve them, and both modes give the same order constraints. The descriptors
+// go back to the slab, so shutting down and registering again over and over never grows it. Resolves racing a
+// shutdown find each singleton or nothing.
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Rounds = 50;
+
+    DI::Container *current = nullptr;
+
+    std::mutex destroyedLock;
+    std::vector<std::string> destroyed;
+
+    void Destroyed(const char *name) {
+        std::lock_guard<std::mutex> lock(destroyedLock);
+        destroyed.emplace_back(name);
+    }
+
+    struct IStore {
+        virtual ~IStore() = default;
+    };
+
+    struct Store : IStore {
+        ~Store() override {
+            Destroyed("Store");
+        }
+    };
+
+    struct ICache {
+        virtual ~ICache() = default;
+    };
+
+    struct Cache : ICache {
+        Cache() : store(current->ResolveSingleton<IStore>()) {}
+
+        ~Cache() override {
+            Tests::Expect(current->TryResolveSingleton<IStore>() == store,
+                          "a destructor resolves the singletons it depends on");
+            Destroyed("Cache");
+        }
+
+        std::shared_ptr<IStore> store;
+    };
+
+    struct IIndex {
+        virtual ~IIndex() = default;
+    };
+
+    struct Index : IIndex {
+        Index() {
+            current->ResolveSingleton<IStore>();
+        }
+
+        ~Index() override {
+            Tests::Expect(current->TryResolveSingleton<IStore>() != nullptr,
+                          "a destructor resolves the singletons it depends on");
+            Destroyed("Index");
+        }
+    };
+
+    struct IApi {
+        virtual ~IApi() = default;
+    };
+
+    struct Api : IApi {
+        Api() {
+            current->ResolveSingleton<ICache>();
+            current->ResolveSingleton<IIndex>();
+        }
+
+        ~Api() override {
+            Tests::Expect(current->TryResolveSingleton<ICache>() && current->TryResolveSingleton<IIndex>(),
+                          "a destructor resolves the singletons it depends on");
+            Destroyed("Api");
+        }
+    };
+
+    struct ILog {
+        virtual ~ILog() = default;
+    };
+
+    struct Log : ILog {
+        ~Log() override {
+            Destroyed("Log");
+        }
+    };
+
+    void RegisterAll(DI::Container &container) {
+        container.RegisterSingleton<IStore, Store>();
+        container.RegisterSingleton<ICache, Cache>();
+        container.RegisterSingleton<IIndex, Index>();
+        container.RegisterSingleton<IApi, Api>();
+        container.RegisterSingleton<ILog, Log>();
+    }
+
+    template<typename TNames>
+    std::ptrdiff_t Position(const TNames &names, const std::string &name) {
+        auto it = std::find(names.begin(), names.end(), name);
+        Tests::Expect(it != names.end(), "every singleton is released");
+        return it - names.begin();
+    }
+
+    /**
+    * @brief Checks that each singleton went before the singletons it depends on.
+    */
+    template<typename TNames>
+    void ExpectOrder(const TNames &names) {
+        Tests::Expect(names.size() == 5, "every singleton is released once");
+        Tests::Expect(Position(names, "Api") < Position(names, "Cache"), "a singleton goes before its dependencies");
+        Tests::Expect(Position(names, "Api") < Position(names, "Index"), "a singleton goes before its dependencies");
+        Tests::Expect(Position(names, "Cache") < Position(names, "Store"), "a singleton goes before its dependencies");
+        Tests::Expect(Position(names, "Index") < Position(names, "Store"), "a singleton goes before its dependencies");
+    }
+
+    /**
+    * @return std::vector<std::string> The implementations released, named after their interface in the reports.
+    */
+    std::vector<std::string> Names(const std::vector<DI::TeardownReport> &reports) {
+        std::vector<std::string> names;
+        for (auto &report: reports) {
+            Tests::Expect(report.destroyed, "a singleton nobody holds is destroyed by the shutdown");
+            for (auto name: {"Store", "Cache", "Index", "Api", "Log"}) {
+                if (report.typeName.find(std::string("I") + name) != std::string::npos) {
+                    names.emplace_back(name);
+                }
+            }
+        }
+
+        return names;
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    current = &container;
+
+    std::size_t descriptors = 0;
+    for (int round = 0; round < Rounds; round++) {
+        destroyed.clear();
+        RegisterAll(container);
+        if (!round) {
+            descriptors = container.MemoryStats().descriptors;
+        }
+
+        auto reports = container.Shutdown(round % 2 == 0);
+        ExpectOrder(destroyed);
+        ExpectOrder(Names(reports));
+        Expect(!container.TryResolveSingleton<IStore>(), "nothing is resolvable after a shutdown");
+        Expect(container.MemoryStats().descriptors == descriptors, "released descriptors go back to the slab");
+    }
+
+    // Resolves racing a shutdown
+    for (int round = 0; round < Rounds; round++) {
+        destroyed.clear();
+        RegisterAll(container);
+
+        std::atomic<bool> done{false};
+        Tests::RunThreads(2, [&](unsigned thread) {
+            if (thread == 0) {
+                container.Shutdown(round % 2 == 0);
+                done = true;
+                return;
+            }
+
+            while (!done) {
+                container.TryResolveSingleton<IStore>();
+                auto logs = container.ResolveAllSingletons<ILog>();
+                for (auto &log: *logs) {
+                    Expect(log != nullptr, "a shutdown hands out complete singletons or none");
+                }
+            }
+        });
+
+        ExpectOrder(destroyed);
+    }
+
+    current = nullptr;
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+#ifndef INJECTTORTEST_TESTSUPPORT_HPP
+#define INJECTTORTEST_TESTSUPPORT_HPP
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/*
+* What the tests share. Each test is a program of its own, registered with ctest, which fails through its exit status.
+*/
+namespace Tests {
+
+    /**
+    * @brief Fails the test, from any thread, when the condition does not hold.
+    */
+    inline void Expect(bool condition, const char *what) {
+        if (!condition) {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            std::fflush(stderr);
+            std::_Exit(EXIT_FAILURE);
+        }
+    }
+
+    /**
+    * @brief Runs the work on the given number of threads, released all at once, and waits for them.
+    *
+    * @param work Called with the index of its thread.
+    */
+    template<typename TWork>
+    void RunThreads(unsigned count, TWork work) {
+        std::atomic<unsigned> ready{0};
+        std::vector<std::thread> threads;
+        for (unsigned index = 0; index < count; index++) {
+            threads.emplace_back([&ready, &work, count, index] {
+                ready.fetch_add(1);
+                while (ready.load() < count) {
+                    std::this_thread::yield();
+                }
+
+                work(index);
+            });
+        }
+
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+}
+
+#endif //INJECTTORTEST_TESTSUPPORT_HPP
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves through the per-thread cache while the registrations are replaced: a replacement invalidates what every
+// thread cached, so the first resolve after it already gets the new implementation.
+
+#include <atomic>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr int Replacements = 1000;
+
+    struct IValue {
+        virtual ~IValue() = default;
+
+        virtual int Value() const = 0;
+    };
+
+    struct One : IValue {
+        int Value() const override {
+            return 1;
+        }
+    };
+
+    struct Two : IValue {
+        int Value() const override {
+            return 2;
+        }
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.EnableThreadCache();
+    container.RegisterTransient<IValue, One>();
+    container.RegisterScoped<IValue, One>();
+
+    // On a single thread, the entry cached by the first resolve is dropped by the replacement
+    Expect(container.ResolveTransient<IValue>()->Value() == 1, "the cache is filled");
+    Expect(container.ResolveTransient<IValue>()->Value() == 1, "the cache hits");
+    container.Replace<IValue, Two>();
+    Expect(container.ResolveTransient<IValue>()->Value() == 2, "a replacement invalidates the cached transient");
+
+    auto scope = container.CreateScope();
+    Expect(container.ResolveScoped<IValue>(scope).lock()->Value() == 2, "a replacement invalidates the cached scoped");
+
+    // Readers keep their cache warm while the writer replaces, then check they see the last replacement
+    std::atomic<int> round{0};
+    Tests::RunThreads(4, [&](unsigned thread) {
+        if (thread == 0) {
+            for (int i = 0; i < Replacements; i++) {
+                if (i % 2) {
+                    container.ReplaceTransient<IValue, Two>();
+                } else {
+                    container.ReplaceTransient<IValue, One>();
+                }
+
+                round = i + 1;
+            }
+
+            return;
+        }
+
+        for (;;) {
+            auto published = round.load();
+            auto value = container.ResolveTransient<IValue>()->Value();
+            if (published == Replacements) {
+                Expect(value == 2, "the first resolve after the last replacement gets it");
+                break;
+            }
+
+            Expect(value == 1 || value == 2, "a cached resolve gets the old or the new implementation");
+        }
+    });
+
+    return 0;
+}
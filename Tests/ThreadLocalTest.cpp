@@ -0,0 +1,86 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Resolves a thread-local service on several threads: each thread gets an instance of its own, the same one on every
+// resolve, until the registration is replaced. Slots of replaced registrations and destroyed containers are recycled.
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    constexpr unsigned Threads = 8;
+
+    struct IBuffer {
+        virtual ~IBuffer() = default;
+
+        virtual int Version() const = 0;
+    };
+
+    struct Buffer : IBuffer {
+        int Version() const override {
+            return 1;
+        }
+
+        const std::thread::id owner = std::this_thread::get_id();
+    };
+
+    struct NewBuffer : IBuffer {
+        int Version() const override {
+            return 2;
+        }
+    };
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    DI::Container container;
+    container.RegisterThreadLocal<IBuffer, Buffer>();
+
+    std::mutex lock;
+    std::vector<std::shared_ptr<IBuffer>> instances;
+    Tests::RunThreads(Threads, [&](unsigned) {
+        auto buffer = container.ResolveThreadLocal<IBuffer>();
+        for (int i = 0; i < 100; i++) {
+            Expect(container.ResolveThreadLocal<IBuffer>() == buffer, "a thread gets the same instance every time");
+        }
+
+        Expect(static_cast<Buffer &>(*buffer).owner == std::this_thread::get_id(),
+               "the instance was constructed by the thread resolving it");
+
+        std::lock_guard<std::mutex> guard(lock);
+        instances.push_back(buffer);
+    });
+
+    std::sort(instances.begin(), instances.end());
+    Expect(std::unique(instances.begin(), instances.end()) == instances.end(),
+           "each thread gets an instance of its own");
+
+    // Replacing hands every thread a new instance, the one of the old registration is no longer counted
+    auto old = container.ResolveThreadLocal<IBuffer>();
+    container.Replace<IBuffer, NewBuffer>();
+    auto replaced = container.ResolveThreadLocal<IBuffer>();
+    Expect(replaced->Version() == 2 && replaced == container.ResolveThreadLocal<IBuffer>(),
+           "the new implementation is resolved once per thread");
+    Expect(container.ThreadLocalInstances().size() == 1 && container.ThreadLocalInstances().front().instances == 1,
+           "only the instance of the current registration is counted");
+
+    // Replacements and containers coming and going recycle their slots, which never hand out the instances of their
+    // previous owner
+    for (int round = 0; round < 1000; round++) {
+        DI::Container scratch;
+        scratch.RegisterThreadLocal<IBuffer, Buffer>();
+        Expect(scratch.ResolveThreadLocal<IBuffer>()->Version() == 1, "a recycled slot holds the new registration");
+        scratch.ReplaceThreadLocal<IBuffer, NewBuffer>();
+        Expect(scratch.ResolveThreadLocal<IBuffer>()->Version() == 2, "a replaced slot holds the new registration");
+    }
+
+    Expect(old->Version() == 1, "instances handed out stay alive");
+    return 0;
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2024 Aedifex Solutions Inc. All rights reserved.
+
+// Checks the dependencies declared through DependsOn against the registrations. A singleton depending on a scoped
+// service does not compile when it declares it as such, and Validate reports it when the dependency it declares as a
+// singleton is registered as scoped. A dependency registered nowhere is reported too, and a valid graph passes, in the
+// container and in its children.
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "Container.hpp"
+#include "TestSupport.hpp"
+
+namespace {
+
+    struct ILogger {
+        virtual ~ILogger() = default;
+    };
+
+    struct Logger : ILogger {
+    };
+
+    struct IUnitOfWork {
+        virtual ~IUnitOfWork() = default;
+    };
+
+    struct UnitOfWork : IUnitOfWork {
+    };
+
+    struct IRepository {
+        virtual ~IRepository() = default;
+    };
+
+    struct Repository : IRepository {
+        using Dependencies = DI::DependsOn<DI::Singleton<ILogger>, DI::Scoped<IUnitOfWork>>;
+    };
+
+    struct IHandler {
+        virtual ~IHandler() = default;
+    };
+
+    struct Handler : IHandler {
+        using Dependencies = DI::DependsOn<DI::Scoped<IRepository>, DI::Transient<IRepository>>;
+    };
+
+    struct ICache {
+        virtual ~ICache() = default;
+    };
+
+    // Declares its dependency as a singleton, which is registered as a scoped service
+    struct Cache : ICache {
+        using Dependencies = DI::DependsOn<DI::Singleton<ILogger>, DI::Singleton<IUnitOfWork>>;
+    };
+
+    struct IMissing {
+        virtual ~IMissing() = default;
+    };
+
+    struct Missing : IMissing {
+    };
+
+    struct IAuditor {
+        virtual ~IAuditor() = default;
+    };
+
+    struct Auditor : IAuditor {
+        using Dependencies = DI::DependsOn<DI::Singleton<IMissing>>;
+    };
+
+    // Declaring a scoped dependency on a singleton does not compile, CheckLifetimes rejects it
+    static_assert(DI::DependsOn<DI::Scoped<IUnitOfWork>>::Captures<DI::Lifetime::Singleton>);
+    static_assert(!DI::DependsOn<DI::Singleton<ILogger>>::Captures<DI::Lifetime::Singleton>);
+    static_assert(!DI::DependsOn<DI::Singleton<ILogger>, DI::Scoped<IUnitOfWork>>::Captures<DI::Lifetime::Scoped>);
+    static_assert(DI::DependsOn<DI::Transient<IRepository>>::Captures<DI::Lifetime::Scoped>);
+
+    /**
+    * @return std::string The problems Validate reports, empty if it passes.
+    */
+    std::string ProblemsOf(const DI::Container &container) {
+        try {
+            container.Validate();
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+
+        return {};
+    }
+
+    void RegisterValid(DI::Container &container) {
+        container.RegisterSingleton<ILogger, Logger>();
+        container.RegisterScoped<IUnitOfWork, UnitOfWork>();
+        container.RegisterScoped<IRepository, Repository>();
+        container.RegisterTransient<IRepository, Repository>();
+        container.RegisterTransient<IHandler, Handler>();
+    }
+
+}
+
+int main() {
+    using Tests::Expect;
+
+    {
+        DI::Container container;
+        RegisterValid(container);
+        Expect(ProblemsOf(container).empty(), "a valid graph passes");
+
+        // Dependencies registered in a parent satisfy a child
+        auto child = container.CreateChild();
+        child->RegisterTransient<IHandler, Handler>("child");
+        Expect(ProblemsOf(*child).empty(), "a child relying on its parent passes");
+    }
+
+    {
+        DI::Container container;
+        RegisterValid(container);
+        container.RegisterSingleton<ICache, Cache>();
+
+        auto problems = ProblemsOf(container);
+        Expect(problems.find("as a singleton service, but it is registered as a scoped service") != std::string::npos,
+               "a singleton depending on a scoped service is reported");
+        Expect(problems.find("ILogger") == std::string::npos, "satisfied dependencies are not reported");
+    }
+
+    {
+        DI::Container container;
+        RegisterValid(container);
+        container.RegisterSingleton<IAuditor, Auditor>();
+
+        auto problems = ProblemsOf(container);
+        Expect(problems.find("IMissing") != std::string::npos, "a missing dependency is named");
+        Expect(problems.find("which is not registered") != std::string::npos, "a missing dependency is reported");
+
+        // Every problem is listed at once
+        container.RegisterSingleton<ICache, Cache>();
+        problems = ProblemsOf(container);
+        Expect(problems.find("which is not registered") != std::string::npos &&
+               problems.find("but it is registered as a scoped service") != std::string::npos,
+               "every problem is reported at once");
+
+        // Registering what was missing leaves the other problem only
+        container.RegisterSingleton<IMissing, Missing>();
+        problems = ProblemsOf(container);
+        Expect(problems.find("which is not registered") == std::string::npos, "a registered dependency is satisfied");
+        Expect(problems.find("but it is registered as a scoped service") != std::string::npos,
+               "the problems left are still reported");
+    }
+
+    return 0;
+}
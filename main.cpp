@@ -11,5 +11,10 @@ int main() {
     WebServerExample::RunWebServerExample();
     AdvancedWebExample::RunWebServerExample();
 
+    for (auto &report: DI::Container::Instance().Shutdown()) {
+        std::cout << "Released " << report.typeName << " '" << report.tag << "' in "
+                  << std::chrono::duration<double, std::micro>(report.duration).count() << " us\n";
+    }
+
     return 0;
 }
\ No newline at end of file
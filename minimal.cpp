@@ -0,0 +1,12 @@
+#include "Examples/MinimalExample.h"
+
+int main() {
+    MinimalExample::RunMinimalExample();
+
+    for (auto &report: DI::Container::Instance().Shutdown()) {
+        std::cout << "Released " << report.typeName << " '" << report.tag << "' in "
+                  << std::chrono::duration<double, std::micro>(report.duration).count() << " us\n";
+    }
+
+    return 0;
+}